@@ -1,370 +1,1086 @@
 /// \file chwordlebot.cpp
 /// \author Chad Hogg
-/// \version 2025-10-30
+/// \version 2026-10-14
 /// I'm sure this has been done a thousand times, but I decided to write a program that plays Wordle.
+/// This file is the command line; the engine that plays is in chwordlebot.h, where other programs can use it too,
+///   and sharing tree searches with other machines is in treeworker.h.
+/// The requests that --serve and --batch answer are described on GameHost, just below.
 
-#include <iostream>
-#include <string>
+#include <array>
 #include <unordered_set>
-#include <unordered_map>
-#include <cassert>
-#include <fstream>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
 
-/// \brief The length of words we want to work with.
-const std::size_t WORD_LENGTH = 5;
-/// \brief The dictionary file that should be used if none is specified.
-const std::string DEFAULT_DICT_NAME = "/usr/share/dict/words";
+#include "chwordlebot.h"
+#include "treeworker.h"
 
-/// \brief A "White" response indicates a letter that does not appear in the word (more times than it already has).
-const char NOT_THERE = 'W';
-/// \brief A "Yellow" response indicates a letter that appears in the word at a different location.
-const char WRONG_SPOT = 'Y';
-/// \brief A "Green" response indicates a letter that appears in the word at its current location.
-const char RIGHT_SPOT = 'G';
+/// \brief The number of times operator new has been called on this thread.
+/// The benchmark uses this to check that playing a game does not allocate.
+thread_local std::size_t allocationsOnThisThread = 0;
+
+// These must not be inlined, or GCC sees operator new and delete paired with malloc and free and complains.
+__attribute__ ((noinline)) void* operator new (std::size_t size) {
+    ++allocationsOnThisThread;
+    void* memory = std::malloc (size == 0 ? 1 : size);
+    if (memory == nullptr) { throw std::bad_alloc (); }
+    return memory;
+}
+
+void* operator new[] (std::size_t size) { return operator new (size); }
+__attribute__ ((noinline)) void operator delete (void* memory) noexcept { std::free (memory); }
+__attribute__ ((noinline)) void operator delete[] (void* memory) noexcept { std::free (memory); }
+__attribute__ ((noinline)) void operator delete (void* memory, std::size_t) noexcept { std::free (memory); }
+__attribute__ ((noinline)) void operator delete[] (void* memory, std::size_t) noexcept { std::free (memory); }
 
 
-/// \brief A group of words that are potential solutions to a puzzle.
-class WordCollection {
+/// \brief Plays lots of games at once, for clients that send requests one line at a time.
+/// Every request and response names the game it is about (the client picks the names):
+///   "NEW game" starts (or restarts) a game, and the answer is "game GUESS word";
+///   "FEEDBACK game guess feedback" says what happened when guess was played (which need not be the one suggested),
+///     and the answer is "game GUESS word", or "game SOLVED n" if the feedback was all RIGHT_SPOT;
+///   "END game" forgets a game, and the answer is "game ENDED";
+///   "PROFILE" asks for the totals kept by profiling builds so far, and the answer is "- PROFILE" and a JSON object.
+/// For scripts there is also a short form: "game" on its own starts a game, and "game feedback" is feedback
+///   on the guess that was just suggested for it.
+/// Anything wrong gets "game ERROR message", and if it was feedback that rules out every word, the game is over.
+/// Games are divided among a few worker threads by a hash of their names, so the requests for each game
+///   are handled in order by one thread, and nothing about a game is ever shared between threads.
+/// Each game breaks ties with its own generator, seeded from the seed and its name, so replaying the same requests
+///   for a game gives the same guesses however many workers there are and whatever the other games are doing.
+/// A game belongs to the client that started it, and a client that goes away can have all of its games dropped.
+/// Responses about different games may come back in a different order than the requests.
+/// Each response is handed to a function given when the host is created, on the worker's thread, along with
+///   which worker it is, the client number that came with the request, and whether that worker has more requests waiting.
+template <std::size_t WORD_LENGTH>
+class GameHost {
 public:
 
-    /// \brief Creates a new collection of words by reading from a list.
-    /// \param[in] in A stream containing the list of known words.
-    /// Strips out any words that are the wrong length of contain non-alphabetic characters.
-    /// Converts all lowercase characters to uppercase characters.
-    WordCollection (std::istream& in) {
-        std::string temp;
-        in >> temp;
-        while (in) {
-            if (temp.length () == WORD_LENGTH) {
-                bool good = true;
-                for (unsigned short index = 0; index < WORD_LENGTH; ++index) {
-                    if (std::islower (temp[index])) {
-                        temp[index] = std::toupper (temp[index]);
-                    }
-                    else if (!std::isalpha (temp[index])) { good = false; }
-                }
-                if (good) {
-                    assert (m_possibleWords.count (temp) == 0);
-                    m_possibleWords.insert (temp);
-                }
-            }
-            in >> temp;
-        }
-    }
-
-    /// \brief Chooses the best word to guess.
-    /// \return A word from the collection.
-    /// It is assumed that by this point the collection only contains words that are consistent with out knowledge so far.
-    /// This uses a heuristc that we would like to include in our guess letters that provide more information,
-    ///   and specifically that letter that appear more frequently in our pool of possible guesses are better
-    ///   to use than those that appear less frequently.
-    /// If multiple words are equally good, it selects between them randomly.
-    std::string bestWord () const
-    {
-        std::unordered_map<char, std::size_t> letterFrequencies;
-        for (char c = 'A'; c <= 'Z'; ++c) { letterFrequencies[c] = 0; }
-        for (const std::string& word : m_possibleWords) {
-            for (char c : word) {
-                ++letterFrequencies[c];
+    /// \brief The kind of function that gets the responses.
+    typedef std::function<void (std::size_t worker, std::uint64_t client, std::string response, bool more)> Responder;
+
+    /// \brief Sets up a host and starts its workers.
+    /// \param[in] dictionary The words, and the way guesses are chosen, which should use one thread.
+    /// \param[in] numWorkers The number of threads that choose guesses.
+    /// \param[in] seed The seed for breaking ties.
+    /// \param[in] responder The function that gets the responses.
+    GameHost (const Dictionary<WORD_LENGTH>& dictionary, unsigned int numWorkers, unsigned int seed, Responder responder)
+    : m_dictionary (dictionary), m_seed (seed), m_responder (responder), m_workers (std::max (1u, numWorkers)) {
+        for (Worker& worker : m_workers) { worker.m_thread = std::thread (&GameHost<WORD_LENGTH>::work, this, std::ref (worker)); }
+    }
+
+    GameHost (const GameHost<WORD_LENGTH>&) = delete;
+    GameHost<WORD_LENGTH>& operator= (const GameHost<WORD_LENGTH>&) = delete;
+
+    /// \brief Stops the workers, which answer every request that has been submitted first.
+    ~GameHost () { finish (); }
+
+    /// \brief Gets the number of worker threads.
+    std::size_t numWorkers () const { return m_workers.size (); }
+
+    /// \brief Answers every request that has been submitted, and then stops the workers.  Nothing more may be submitted.
+    void finish () {
+        for (Worker& worker : m_workers) {
+            {
+                std::lock_guard<std::mutex> lock (worker.m_mutex);
+                worker.m_stopping = true;
             }
+            worker.m_ready.notify_one ();
         }
-        std::unordered_set<std::string> bestOptions;
-        std::size_t bestScore = 0;
-        for (const std::string& word : m_possibleWords) {
-            std::size_t score = 0;
-            std::unordered_set<char> alreadySeen;
-            for (char c : word) { 
-                if (alreadySeen.count (c) == 0) {
-                    score += letterFrequencies[c];
-                }
-                alreadySeen.insert (c);
+        for (Worker& worker : m_workers) {
+            if (worker.m_thread.joinable ()) { worker.m_thread.join (); }
+        }
+    }
+
+    /// \brief Queues a request for the worker that owns its game.
+    /// \param[in] client A number that is passed along with the response, to say where it should go.
+    /// \param[in] line The request, without the newline.
+    void submit (std::uint64_t client, std::string line) {
+        if (!line.empty () && line.back () == '\r') { line.pop_back (); }
+        std::istringstream in (line);
+        std::string first, second;
+        if (!(in >> first)) { return; }
+        in >> second;
+        const std::string& game = isCommand (first) ? second : first;
+        Worker& worker = m_workers[std::hash<std::string> () (game) % m_workers.size ()];
+        {
+            std::lock_guard<std::mutex> lock (worker.m_mutex);
+            worker.m_jobs.push_back ({client, std::move (line)});
+        }
+        worker.m_ready.notify_one ();
+    }
+
+    /// \brief Forgets every game a client started, once the requests it has already submitted are answered.
+    /// \param[in] client The number that came with the client's requests.
+    void dropClient (std::uint64_t client) {
+        for (Worker& worker : m_workers) {
+            {
+                std::lock_guard<std::mutex> lock (worker.m_mutex);
+                worker.m_jobs.push_back ({client, std::string (), true});
             }
-            if (score > bestScore) {
-                bestOptions.clear ();
-                bestOptions.insert (word);
-                bestScore = score;
+            worker.m_ready.notify_one ();
+        }
+    }
+
+private:
+
+    /// \brief One game.
+    struct Session {
+        explicit Session (const Dictionary<WORD_LENGTH>& dictionary) : m_game (dictionary) {}
+        GameSession<WORD_LENGTH> m_game;
+        /// \brief The guess that was suggested last, which the short form of feedback is about.
+        Word<WORD_LENGTH> m_suggested;
+        /// \brief The game's own generator for breaking ties.
+        std::mt19937 m_rng;
+        /// \brief The client that started the game.
+        std::uint64_t m_client;
+    };
+
+    /// \brief A request waiting for a worker.
+    struct Job {
+        std::uint64_t m_client;
+        std::string m_line;
+        /// \brief True if this is not a request but dropClient () for m_client.
+        bool m_drop = false;
+    };
+
+    /// \brief A worker thread, the requests waiting for it, and the games that belong to it.
+    struct Worker {
+        std::thread m_thread;
+        std::mutex m_mutex;
+        std::condition_variable m_ready;
+        std::deque<Job> m_jobs;
+        bool m_stopping = false;
+        std::unordered_map<std::string, Session> m_sessions;
+        /// \brief The names of the games that each client started.
+        std::unordered_map<std::uint64_t, std::unordered_set<std::string>> m_gamesOf;
+    };
+
+    /// \brief Tests whether a word is one of the long-form commands, rather than the name of a game.
+    static bool isCommand (const std::string& word) { return word == "NEW" || word == "FEEDBACK" || word == "END" || word == "PROFILE"; }
+
+    /// \brief Runs a worker: takes requests in order and answers them, until it is stopped and has nothing left to do.
+    void work (Worker& worker) {
+        std::size_t index = &worker - m_workers.data ();
+        while (true) {
+            Job job;
+            bool more;
+            {
+                std::unique_lock<std::mutex> lock (worker.m_mutex);
+                worker.m_ready.wait (lock, [&worker] { return !worker.m_jobs.empty () || worker.m_stopping; });
+                if (worker.m_jobs.empty ()) { return; }
+                job = std::move (worker.m_jobs.front ());
+                worker.m_jobs.pop_front ();
+                more = !worker.m_jobs.empty ();
             }
-            else if (score == bestScore) {
-                bestOptions.insert (word);
+            if (job.m_drop) {
+                auto games = worker.m_gamesOf.find (job.m_client);
+                if (games == worker.m_gamesOf.end ()) { continue; }
+                for (const std::string& game : games->second) { worker.m_sessions.erase (game); }
+                worker.m_gamesOf.erase (games);
+                continue;
             }
+            m_responder (index, job.m_client, handle (worker, job.m_client, job.m_line), more);
         }
+    }
 
-        std::size_t randomIndex = rand () % bestOptions.size ();
-        auto iter = bestOptions.begin ();
-        std::advance (iter, randomIndex);
-        return *iter;
+    /// \brief Computes a fingerprint of a game's name, which is the same on every machine.
+    static std::uint64_t hashName (const std::string& game) {
+        std::uint64_t result = 14695981039346656037ull;
+        for (unsigned char c : game) { result = (result ^ c) * 1099511628211ull; }
+        return result;
     }
 
-    /// \brief The collection of words.
-    /// This is not private because ConstraintCollection::processNewConstraints() removes things from it.
-    /// Maybe they should just be friends.
-    std::unordered_set<std::string> m_possibleWords;
-};
+    /// \brief Forgets a game.
+    void endSession (Worker& worker, typename std::unordered_map<std::string, Session>::iterator iter) {
+        auto games = worker.m_gamesOf.find (iter->second.m_client);
+        if (games != worker.m_gamesOf.end ()) {
+            games->second.erase (iter->first);
+            if (games->second.empty ()) { worker.m_gamesOf.erase (games); }
+        }
+        worker.m_sessions.erase (iter);
+    }
 
-/// \brief A type of constraint.
-/// I was originally using inheritence so that I could have a collection of all constraints of any type.
-/// But to get dynamic dispatch, I would need a collection of pointers to them.
-/// But of course I wouldn't want to hash the pointers themselves, but the values.
-/// And that seemed posssible, but probably not worth the effort.
-/// So this base class is entirely vestigial and could be removed.
-class Constraint {
-public:
+    /// \brief Carries out one request.
+    /// \param[in,out] worker The worker whose game it is.
+    /// \param[in] client The number that came with the request.
+    /// \param[in] line The request.
+    /// \return The response, including the newline.
+    std::string handle (Worker& worker, std::uint64_t client, const std::string& line) {
+        std::istringstream in (line);
+        std::string command, game, guess, feedback, extra;
+        in >> command;
+        if (!isCommand (command)) {
+            // The short form: the game, and maybe feedback on the last suggestion.
+            game = command;
+            command = (in >> feedback) ? "FEEDBACK" : "NEW";
+        }
+        else { in >> game; }
+        if (command == "PROFILE") { return "- PROFILE " + profileReport () + "\n"; }
+        if (game.empty ()) { return "- ERROR no game named\n"; }
+        auto iter = worker.m_sessions.find (game);
+        if (command == "END") {
+            if (iter != worker.m_sessions.end ()) { endSession (worker, iter); }
+            return game + " ENDED\n";
+        }
+        if (command == "NEW") {
+            if (iter != worker.m_sessions.end ()) { endSession (worker, iter); }
+            Session& session = worker.m_sessions.emplace (game, Session (m_dictionary)).first->second;
+            std::uint64_t hash = hashName (game);
+            session.m_rng.seed (m_seed + std::uint32_t (hash ^ (hash >> 32)));
+            session.m_client = client;
+            worker.m_gamesOf[client].insert (game);
+            return suggest (game, session);
+        }
+        if (iter == worker.m_sessions.end ()) { return game + " ERROR no such game\n"; }
+        Session& session = iter->second;
+        if (feedback.empty ()) {
+            if (!(in >> guess >> feedback)) { return game + " ERROR expected FEEDBACK game guess feedback\n"; }
+        }
+        else { guess = session.m_suggested.toString (); }
+        if (in >> extra) { return game + " ERROR too much on one line\n"; }
+        if (guess.length () != WORD_LENGTH || !std::all_of (guess.begin (), guess.end (), [] (char c) { return std::isalpha (c); })) {
+            return game + " ERROR the guess must be " + std::to_string (WORD_LENGTH) + " letters\n";
+        }
+        if (!isFeedbackString<WORD_LENGTH> (feedback)) {
+            return game + " ERROR the feedback must be " + std::to_string (WORD_LENGTH) + " of " + NOT_THERE + WRONG_SPOT + RIGHT_SPOT + "\n";
+        }
+        for (char& c : guess) { c = std::toupper (c); }
+        if (feedback == std::string (WORD_LENGTH, RIGHT_SPOT)) {
+            std::string response = game + " SOLVED " + std::to_string (session.m_game.numGuesses () + 1) + "\n";
+            endSession (worker, iter);
+            return response;
+        }
+        if (!session.m_game.observe (Word<WORD_LENGTH> (guess), feedback)) {
+            endSession (worker, iter);
+            return game + " ERROR no word in the dictionary fits that feedback\n";
+        }
+        return suggest (game, session);
+    }
+
+    /// \brief Chooses the next guess for a game.
+    std::string suggest (const std::string& game, Session& session) {
+        session.m_suggested = session.m_game.suggest (session.m_rng);
+        return game + " GUESS " + session.m_suggested.toString () + "\n";
+    }
 
-    /// \brief Tests whether or not a word satisfies this constraint.
-    /// \param[in] str The word to test.
-    /// \return True if the word satisfies the constraint; false otherwise.
-    virtual bool
-    satisfies (const std::string& str) const = 0;
+    const Dictionary<WORD_LENGTH>& m_dictionary;
+    unsigned int m_seed;
+    Responder m_responder;
+    std::vector<Worker> m_workers;
 };
 
 
-/// \brief A constraint regarding a specific location within a word.
-/// There are two types: must-match and may-not-match.
-class PositionConstraint : public Constraint {
+/// \brief Serves games to clients that connect over TCP, keeping everything loaded from one game to the next.
+/// The requests and responses are the ones that GameHost understands, one per line.
+/// One thread runs an epoll loop that accepts connections, reads requests and hands them to the host,
+///   and writes responses, which the workers leave in an outbox and signal with an eventfd.
+template <std::size_t WORD_LENGTH>
+class Server {
 public:
 
-    /// \brief Creates a new position-related constraint.
-    /// \param[in] index The position where something should be true.
-    /// \param[in] letter The character that might be in that position.
-    /// \param[in] shouldMatch True if the character must be in the position; false if it may not be.
-    PositionConstraint (unsigned short index, char letter, bool shouldMatch)
-    : m_index (index), m_letter (letter), m_shouldMatch (shouldMatch) {
-        assert (index < WORD_LENGTH);
-        assert (letter >= 'A' && letter <= 'Z');
+    /// \brief Sets up a server.
+    /// \param[in] dictionary The words, and the way guesses are chosen, which should use one thread.
+    /// \param[in] numWorkers The number of threads that choose guesses.
+    /// \param[in] seed The seed for breaking ties.
+    Server (const Dictionary<WORD_LENGTH>& dictionary, unsigned int numWorkers, unsigned int seed)
+    : m_wake (eventfd (0, EFD_NONBLOCK)),
+      m_host (dictionary, numWorkers, seed, [this] (std::size_t, std::uint64_t client, std::string response, bool) {
+          respond (client, std::move (response));
+      }) {}
+
+    Server (const Server<WORD_LENGTH>&) = delete;
+    Server<WORD_LENGTH>& operator= (const Server<WORD_LENGTH>&) = delete;
+
+    /// \brief Listens for connections and answers requests, forever.
+    /// \param[in] port The TCP port to listen on.
+    /// \param[in,out] log The stream to report problems to.
+    /// \return False if the server could not be started; otherwise it does not return.
+    bool run (unsigned short port, std::ostream& log) {
+        int listener = socket (AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        int yes = 1;
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl (INADDR_ANY);
+        address.sin_port = htons (port);
+        if (listener < 0 || setsockopt (listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof (yes)) != 0
+            || bind (listener, reinterpret_cast<sockaddr*> (&address), sizeof (address)) != 0 || listen (listener, SOMAXCONN) != 0) {
+            log << "Could not listen on port " << port << ": " << std::strerror (errno) << "\n";
+            return false;
+        }
+        m_epoll = epoll_create1 (0);
+        if (m_epoll < 0 || m_wake < 0 || !watch (listener, LISTENER, EPOLLIN) || !watch (m_wake, WAKE, EPOLLIN)) {
+            log << "Could not set up the event loop: " << std::strerror (errno) << "\n";
+            return false;
+        }
+        log << "Serving games on port " << port << " with " << m_host.numWorkers () << " workers\n";
+
+        std::uint64_t nextConnection = FIRST_CONNECTION;
+        epoll_event events[MAX_EVENTS];
+        while (true) {
+            int count = epoll_wait (m_epoll, events, MAX_EVENTS, -1);
+            for (int e = 0; e < count; ++e) {
+                std::uint64_t id = events[e].data.u64;
+                if (id == LISTENER) {
+                    int fd;
+                    while ((fd = accept4 (listener, nullptr, nullptr, SOCK_NONBLOCK)) >= 0) {
+                        setsockopt (fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof (yes));
+                        if (!watch (fd, nextConnection, EPOLLIN)) { close (fd); continue; }
+                        m_connections[nextConnection].m_fd = fd;
+                        ++nextConnection;
+                    }
+                }
+                else if (id == WAKE) { deliverResponses (); }
+                else {
+                    auto iter = m_connections.find (id);
+                    if (iter == m_connections.end ()) { continue; }
+                    bool open = true;
+                    if (events[e].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) { open = readRequests (id, iter->second); }
+                    if (open && (events[e].events & EPOLLOUT)) { open = flush (id, iter->second); }
+                    if (!open) { disconnect (iter); }
+                }
+            }
+        }
     }
 
-    virtual bool
-    satisfies (const std::string& str) const {
-        return (str.at (m_index) == m_letter) == m_shouldMatch;
+private:
+
+    /// \brief The epoll identifiers of the listening socket and the wake-up eventfd; connections are numbered after them.
+    static constexpr std::uint64_t LISTENER = 0;
+    static constexpr std::uint64_t WAKE = 1;
+    static constexpr std::uint64_t FIRST_CONNECTION = 2;
+    /// \brief The most events handled per call to epoll_wait ().
+    static constexpr int MAX_EVENTS = 256;
+    /// \brief The longest request line that is accepted; a connection that sends a longer one is dropped.
+    static constexpr std::size_t MAX_LINE = 256;
+
+    /// \brief A client, which only the event loop thread touches.
+    struct Connection {
+        int m_fd = -1;
+        /// \brief What has been read but is not a whole line yet.
+        std::string m_in;
+        /// \brief What has not been written yet.
+        std::string m_out;
+        /// \brief True if epoll is watching for the socket to be writable.
+        bool m_waitingToWrite = false;
+    };
+
+    /// \brief A response on its way from a worker to a connection.
+    struct Response {
+        std::uint64_t m_connection;
+        std::string m_text;
+    };
+
+    /// \brief Adds a file descriptor to the epoll set.
+    bool watch (int fd, std::uint64_t id, std::uint32_t events) {
+        epoll_event event = {};
+        event.events = events;
+        event.data.u64 = id;
+        return epoll_ctl (m_epoll, EPOLL_CTL_ADD, fd, &event) == 0;
     }
 
-    bool operator== (const PositionConstraint& other) const {
-        return m_index == other.m_index && m_letter == other.m_letter && m_shouldMatch == other.m_shouldMatch;
+    /// \brief Reads whatever a client has sent and hands each whole line to the host.
+    /// \return False if the connection should be closed.
+    bool readRequests (std::uint64_t id, Connection& connection) {
+        char buffer[4096];
+        while (true) {
+            ssize_t got = read (connection.m_fd, buffer, sizeof (buffer));
+            if (got == 0) { return false; }
+            if (got < 0) { return errno == EAGAIN || errno == EWOULDBLOCK; }
+            connection.m_in.append (buffer, got);
+            std::size_t start = 0, end;
+            while ((end = connection.m_in.find ('\n', start)) != std::string::npos) {
+                m_host.submit (id, connection.m_in.substr (start, end - start));
+                start = end + 1;
+            }
+            connection.m_in.erase (0, start);
+            if (connection.m_in.length () > MAX_LINE) { return false; }
+        }
     }
 
-    const unsigned short m_index;
-    const char m_letter;
-    const bool m_shouldMatch;
-};
+    /// \brief Hands a response from a worker to the event loop.
+    void respond (std::uint64_t connection, std::string text) {
+        {
+            std::lock_guard<std::mutex> lock (m_outboxMutex);
+            m_outbox.push_back ({connection, std::move (text)});
+        }
+        std::uint64_t one = 1;
+        if (write (m_wake, &one, sizeof (one)) < 0) { assert (errno == EAGAIN); }
+    }
 
-std::ostream& operator<< (std::ostream& out, const PositionConstraint& c) {
-    if (c.m_shouldMatch) {
-        out << "Position " << c.m_index << " must be a " << c.m_letter << ".";
+    /// \brief Moves the responses the workers have finished into their connections' buffers, and starts writing them.
+    void deliverResponses () {
+        std::uint64_t count;
+        if (read (m_wake, &count, sizeof (count)) < 0) { assert (errno == EAGAIN); }
+        {
+            std::lock_guard<std::mutex> lock (m_outboxMutex);
+            m_delivering.swap (m_outbox);
+        }
+        for (Response& response : m_delivering) {
+            auto iter = m_connections.find (response.m_connection);
+            if (iter != m_connections.end ()) { iter->second.m_out += response.m_text; }
+        }
+        for (Response& response : m_delivering) {
+            auto iter = m_connections.find (response.m_connection);
+            if (iter != m_connections.end () && !iter->second.m_out.empty () && !flush (iter->first, iter->second)) { disconnect (iter); }
+        }
+        m_delivering.clear ();
     }
-    else {
-        out << "Position " << c.m_index << " may not be " << c.m_letter << ".";
+
+    /// \brief Writes as much of a connection's buffer as the socket will take, and has epoll say when it will take more.
+    /// \return False if the connection should be closed.
+    bool flush (std::uint64_t id, Connection& connection) {
+        std::size_t sent = 0;
+        while (sent < connection.m_out.length ()) {
+            ssize_t wrote = send (connection.m_fd, connection.m_out.data () + sent, connection.m_out.length () - sent, MSG_NOSIGNAL);
+            if (wrote < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK) { return false; }
+                break;
+            }
+            sent += wrote;
+        }
+        connection.m_out.erase (0, sent);
+        bool waiting = !connection.m_out.empty ();
+        if (waiting != connection.m_waitingToWrite) {
+            epoll_event event = {};
+            event.events = waiting ? EPOLLIN | EPOLLOUT : EPOLLIN;
+            event.data.u64 = id;
+            epoll_ctl (m_epoll, EPOLL_CTL_MOD, connection.m_fd, &event);
+            connection.m_waitingToWrite = waiting;
+        }
+        return true;
     }
-    return out;
-}
 
+    /// \brief Closes a connection, and forgets the games it started.
+    /// Responses that are still on their way to it are dropped when they arrive.
+    void disconnect (typename std::unordered_map<std::uint64_t, Connection>::iterator iter) {
+        close (iter->second.m_fd);
+        m_host.dropClient (iter->first);
+        m_connections.erase (iter);
+    }
 
-/// \brief A constraint regarding the number of times a letter appears within a word.
-/// There are two types: minimum and maximum.
-class LetterCountConstraint : public Constraint {
+    int m_epoll = -1;
+    int m_wake;
+    std::unordered_map<std::uint64_t, Connection> m_connections;
+    std::mutex m_outboxMutex;
+    /// \brief Responses the workers have finished.
+    std::vector<Response> m_outbox;
+    /// \brief The responses being delivered, which are swapped out of m_outbox so the workers do not wait.
+    std::vector<Response> m_delivering;
+    /// \brief The games, which is last so that its workers are stopped before anything they respond to goes away.
+    GameHost<WORD_LENGTH> m_host;
+};
+
+
+/// \brief Plays games whose requests come from one file descriptor, writing the responses to another, for scripts.
+/// The requests and responses are the ones that GameHost understands, one per line.
+/// The calling thread reads and splits requests while the host's workers choose guesses, and each worker
+///   saves up its responses and writes them in big pieces instead of one line at a time.
+/// A worker writes what it has saved when the piece is big enough, or when it has nothing left to do and
+///   there is nothing more to read yet, so a script that waits for each response before sending more still gets it.
+template <std::size_t WORD_LENGTH>
+class BatchPlayer {
 public:
 
-    /// \brief Creates a new count-related constraint.
-    /// \param[in] count The number of copies of a character that are allowed.
-    /// \param[in] letter The character that should be counted.
-    /// \param[in] min True if the we are imposing a lower limit; false if imposing an upper limit.
-    LetterCountConstraint (unsigned short count, char letter, bool min)
-    : m_count (count), m_letter (letter), m_min (min) {
-        assert (m_count < WORD_LENGTH);
-        assert (m_letter >= 'A' && m_letter <= 'Z');
+    /// \brief Sets up to play games.
+    /// \param[in] dictionary The words, and the way guesses are chosen, which should use one thread.
+    /// \param[in] numWorkers The number of threads that choose guesses.
+    /// \param[in] seed The seed for breaking ties.
+    /// \param[in] out The file descriptor to write responses to.
+    BatchPlayer (const Dictionary<WORD_LENGTH>& dictionary, unsigned int numWorkers, unsigned int seed, int out)
+    : m_out (out), m_buffers (std::max (1u, numWorkers)),
+      m_host (dictionary, numWorkers, seed, [this] (std::size_t worker, std::uint64_t, std::string response, bool more) {
+          save (worker, response, more);
+      }) {}
+
+    BatchPlayer (const BatchPlayer<WORD_LENGTH>&) = delete;
+    BatchPlayer<WORD_LENGTH>& operator= (const BatchPlayer<WORD_LENGTH>&) = delete;
+
+    /// \brief Reads and answers requests until the end of the input.
+    /// \param[in] in The file descriptor to read requests from.
+    /// \return The number of requests.
+    std::size_t run (int in) {
+        std::vector<char> buffer (READ_SIZE);
+        std::string partial;
+        std::size_t count = 0;
+        while (true) {
+            pollfd ready = {in, POLLIN, 0};
+            if (poll (&ready, 1, 0) == 0) {
+                // Nothing is waiting to be read, so whoever is sending may be waiting for responses.
+                m_idle.store (true);
+                flushAll ();
+            }
+            ssize_t got = read (in, buffer.data (), buffer.size ());
+            if (got < 0 && errno == EINTR) { continue; }
+            if (got <= 0) { break; }
+            m_idle.store (false);
+            std::size_t start = 0;
+            for (std::size_t end = 0; end < std::size_t (got); ++end) {
+                if (buffer[end] != '\n') { continue; }
+                if (partial.empty ()) { m_host.submit (0, std::string (buffer.data () + start, end - start)); }
+                else {
+                    partial.append (buffer.data () + start, end - start);
+                    m_host.submit (0, std::move (partial));
+                    partial.clear ();
+                }
+                ++count;
+                start = end + 1;
+            }
+            partial.append (buffer.data () + start, got - start);
+        }
+        if (!partial.empty ()) {
+            m_host.submit (0, std::move (partial));
+            ++count;
+        }
+        m_idle.store (true);
+        m_host.finish ();
+        flushAll ();
+        return count;
+    }
+
+private:
+
+    /// \brief How much is read at a time.
+    static constexpr std::size_t READ_SIZE = 1 << 20;
+    /// \brief How much a worker saves up before writing it no matter what.
+    static constexpr std::size_t WRITE_SIZE = 1 << 16;
+
+    /// \brief The responses a worker has not written yet.
+    struct Buffer {
+        std::mutex m_mutex;
+        std::string m_text;
+    };
+
+    /// \brief Saves a response, and writes what has been saved if it is time to.
+    void save (std::size_t worker, const std::string& response, bool more) {
+        Buffer& buffer = m_buffers[worker];
+        std::lock_guard<std::mutex> lock (buffer.m_mutex);
+        buffer.m_text += response;
+        if (buffer.m_text.length () >= WRITE_SIZE || (!more && m_idle.load ())) { flush (buffer); }
     }
 
-    virtual bool
-    satisfies (const std::string& str) const {
-        unsigned short amt = 0;
-        for (char c : str) {
-            if (c == m_letter) { ++amt; }
+    /// \brief Writes what every worker has saved.
+    void flushAll () {
+        for (Buffer& buffer : m_buffers) {
+            std::lock_guard<std::mutex> lock (buffer.m_mutex);
+            flush (buffer);
         }
-        if (m_min) { return amt >= m_count; }
-        else { return amt <= m_count; }
     }
 
-    bool operator== (const LetterCountConstraint& other) const {
-        return m_count == other.m_count && m_letter == other.m_letter && m_min == other.m_min;
+    /// \brief Writes what a worker has saved, which must be locked.  Only whole responses are ever written together.
+    void flush (Buffer& buffer) {
+        if (buffer.m_text.empty ()) { return; }
+        std::lock_guard<std::mutex> lock (m_outMutex);
+        std::size_t sent = 0;
+        while (sent < buffer.m_text.length ()) {
+            ssize_t wrote = write (m_out, buffer.m_text.data () + sent, buffer.m_text.length () - sent);
+            if (wrote < 0 && errno == EINTR) { continue; }
+            if (wrote <= 0) { break; }
+            sent += wrote;
+        }
+        buffer.m_text.clear ();
     }
 
-    const unsigned short m_count;
-    const char m_letter;
-    const bool m_min;
+    int m_out;
+    std::mutex m_outMutex;
+    /// \brief True if the last look at the input found nothing waiting.
+    std::atomic<bool> m_idle {false};
+    std::vector<Buffer> m_buffers;
+    /// \brief The games, which is last so that its workers are stopped before the buffers go away.
+    GameHost<WORD_LENGTH> m_host;
 };
 
-std::ostream& operator<< (std::ostream& out, const LetterCountConstraint& c) {
-    if (c.m_min) {
-        out << "Word must contain at least " << c.m_count << " copies of " << c.m_letter << ".";
-    }
-    else {
-        out << "Word must contain at most " << c.m_count << " copies of " << c.m_letter << ".";
-    }
-    return out;
+
+/// \brief Decides how much memory the feedback patterns may take if the command line does not say.
+/// \return Half of the physical memory, or 4 GB if that cannot be found out.
+std::size_t
+defaultPatternBudget () {
+    long pages = sysconf (_SC_PHYS_PAGES);
+    long pageSize = sysconf (_SC_PAGE_SIZE);
+    if (pages <= 0 || pageSize <= 0) { return std::size_t (4) << 30; }
+    return std::size_t (pages) * std::size_t (pageSize) / 2;
 }
 
-template <>
-struct std::hash<PositionConstraint>
-{
-  std::size_t operator()(const PositionConstraint& c) const
-  {
-    return c.m_index + c.m_letter * 5 + (c.m_shouldMatch ? 1000 : 0);
-  }
-};
 
-template <>
-struct std::hash<LetterCountConstraint>
-{
-  std::size_t operator()(const LetterCountConstraint& c) const
-  {
-    return c.m_count + c.m_letter * 5 + (c.m_min ? 1000 : 0);
-  }
+/// \brief Everything that can be set on the command line.
+struct Options {
+    unsigned int seed = time (NULL);
+    std::string dictName = DEFAULT_DICT_NAME;
+    std::string patternCacheName = DEFAULT_PATTERN_CACHE_NAME;
+    std::string strategyName = FREQUENCY_STRATEGY_NAME;
+    unsigned int numThreads = std::max (1u, std::thread::hardware_concurrency ());
+    bool bench = false;
+    std::size_t sampleSize = 0;
+    std::string bookName = DEFAULT_BOOK_NAME;
+    bool buildBook = false;
+    std::size_t bookDepth = DEFAULT_BOOK_DEPTH;
+    std::size_t treeBreadth = DEFAULT_TREE_BREADTH;
+    std::size_t shortlistSize = 0;
+    std::size_t sampleStride = DEFAULT_SAMPLE_STRIDE;
+    /// \brief How many microseconds choosing a guess may take, or 0 for no limit.
+    std::size_t deadline = 0;
+    /// \brief The TCP port to serve games on, or 0 to play one game on the console.
+    unsigned short servePort = 0;
+    /// \brief True to play games whose requests come from standard input, for scripts.
+    bool batch = false;
+    /// \brief The number of puzzles played at once with the same guesses.
+    std::size_t numBoards = 1;
+    /// \brief True if every guess has to use the hints from the earlier ones.
+    bool hardMode = false;
+    /// \brief True to score guesses on a GPU where that helps, in builds that can.
+    bool useDevice = false;
+    /// \brief The TCP port to serve pieces of decision-tree searches on, or 0 to not be a tree worker.
+    unsigned short treeWorkerPort = 0;
+    /// \brief The tree workers to share decision-tree searches with, as host:port.
+    std::vector<std::string> treeHelpers;
+    /// \brief How many seconds to wait on a tree worker before doing its piece here, or 0 to wait forever.
+    unsigned int treeTimeout = DEFAULT_TREE_TIMEOUT;
+    /// \brief The file to write the profile to at exit, or empty for standard error (in builds that keep one).
+    std::string profileName;
+    std::size_t memoSize = DEFAULT_MEMO_SIZE;
+    /// \brief The most memory, in bytes, that the feedback patterns may take before they are worked out as needed instead.
+    std::size_t patternBudget = defaultPatternBudget ();
+    std::string saveDictName;
+    std::string guessListName;
+    /// \brief The length of words, or 0 to go by the dictionary.
+    std::size_t wordLength = 0;
+    /// \brief True to check the feedback kernels and do nothing else.
+    bool selfTest = false;
 };
 
+/// \brief What main () understands, for --help and for anyone who types something it does not.
+const char* const USAGE =
+    "Usage: chwordlebot [word list] [options]\n"
+    "Words:     --guesses FILE  --length N  --save-dict FILE\n"
+    "Choosing:  --strategy frequency|entropy|expected|worst|optimal|minimax  --hard  --boards N  --seed N  --threads N\n"
+    "           --shortlist N  --sample-stride N  --deadline MICROSECONDS  --memo-size N  --gpu\n"
+    "Caches:    --patterns FILE  --pattern-budget MB  --book FILE  --build-book  --book-depth N  --tree-breadth N\n"
+    "Playing:   --bench  --sample N  --serve PORT  --batch  --self-test  --profile FILE  --help\n"
+    "Trees:     --tree-worker PORT  --tree-helpers HOST:PORT,...  --tree-timeout SECONDS\n"
+    "Without --bench, --serve or --batch it plays one game on the console.\n";
 
-/// \brief A collection of constraints.
-/// The constraints are divided into two types (because merging them seemed more trouble than it was worth).
-/// Finished constraints are those that all valid words are already satisfying.
-/// New constraints are those that have not been checked against words yet.
-class ConstraintCollection {
-public:
 
-    /// \brief Creates all of the position-related constraints implied by the feedback to a guess.
-    /// \param[in] guess The word that was guessed.
-    /// \param[in] feedback The response that was received about the guess.
-    /// \return A set of all position-related constraints that can be created from this.
-    /// If feedback says that a character is in the correct position, we get a constraint that it *must* be there.
-    /// If feedback says that a character is in the wrong position, we get a constraint that it *may not* be there.
-    static std::unordered_set<PositionConstraint>
-    generatePositionConstraints (const std::string& guess, const std::string& feedback) {
-        assert (guess.length () == WORD_LENGTH && feedback.length () == WORD_LENGTH);
-        for (char c : guess) { assert (c >= 'A' && c <= 'Z'); }
-        for (char c : feedback) { assert (c == NOT_THERE || c == WRONG_SPOT || c == RIGHT_SPOT); }
-        std::unordered_set<PositionConstraint> constraints;
-        for (unsigned short index = 0; index < WORD_LENGTH; ++index) {
-            if (feedback[index] == RIGHT_SPOT) {
-                constraints.insert ({index, guess[index], true});
-            }
-            if (feedback[index] == WRONG_SPOT) {
-                constraints.insert ({index, guess[index], false});
-            }
+/// \brief Works out feedback the slow, obvious way, to check the fast versions against.
+/// \param[in] guess The word that was guessed.
+/// \param[in] answer The secret word, which is the same length.
+/// \return The feedback, like WWYWG.
+inline std::string
+referenceFeedback (const std::string& guess, const std::string& answer) {
+    std::string feedback (guess.length (), NOT_THERE);
+    std::string left = answer;
+    for (std::size_t index = 0; index < guess.length (); ++index) {
+        if (guess[index] == answer[index]) {
+            feedback[index] = RIGHT_SPOT;
+            left[index] = ' ';
         }
-        return constraints;
-    }
-
-    /// \brief Creates all of the count-related constraints implied by the feedback to a guess.
-    /// \param[in] guess The word that was guessed.
-    /// \param[in] feedback The response that was received about the guess.
-    /// \return A set of all count-related constraints that can be created from this.
-    /// If feedback says there are X green/yellow copies of a letter, the word must contain at least X copies.
-    /// If feedback says there are X green/yellow copies of a letter and not another, the word must contain at most X copies.
-    static std::unordered_set<LetterCountConstraint>
-    generateLetterCountConstraints (const std::string& guess, const std::string& feedback) {
-        assert (guess.length () == WORD_LENGTH && feedback.length () == WORD_LENGTH);
-        for (char c : guess) { assert (c >= 'A' && c <= 'Z'); }
-        for (char c : feedback) { assert (c == NOT_THERE || c == WRONG_SPOT || c == RIGHT_SPOT); }
-        std::unordered_set<LetterCountConstraint> constraints;
-        for (unsigned short index = 0; index < WORD_LENGTH; ++index) {
-            if (feedback[index] == WRONG_SPOT) {
-                unsigned short count = 0;
-                for (char c : guess) {
-                    if (c == guess[index] && (feedback[index] == WRONG_SPOT || feedback[index] == RIGHT_SPOT)) { ++count; }
-                }
-                constraints.insert ({count, guess[index], true});
-            }
-            else if (feedback[index] == NOT_THERE) {
-                unsigned short count = 0;
-                for (char c : guess) {
-                    if (c == guess[index] && (feedback[index] == WRONG_SPOT || feedback[index] == RIGHT_SPOT)) { ++count; }
-                }
-                constraints.insert ({count, guess[index], false});
-            }
+    }
+    for (std::size_t index = 0; index < guess.length (); ++index) {
+        if (feedback[index] == RIGHT_SPOT) { continue; }
+        std::size_t copy = left.find (guess[index]);
+        if (copy != std::string::npos) {
+            feedback[index] = WRONG_SPOT;
+            left[copy] = ' ';
         }
-        return constraints;
-    }
-
-    /// \brief Applies all new constraints to a set of words.
-    /// \param[in] candidates The set of words to modify.
-    /// Any words for which there is at least one constraint they do not satisfy are removed.
-    /// Then all "new" constraints become "finished" constraints.
-    void
-    processNewConstraints(std::unordered_set<std::string>& candidates) {
-        for (auto iter = candidates.begin (); iter != candidates.end (); ) {
-            bool good = true;
-            for (auto iter2 = m_newPositionConstraints.cbegin (); iter2 != m_newPositionConstraints.cend () && good; ++iter2) {
-                if (!iter2->satisfies (*iter)) {
-                    //std::cout << "Throwing out " << *iter << " because of " << *iter2 << "\n";
-                    good = false;
-                }
-            }
-            for (auto iter2 = m_newLetterCountConstraints.cbegin (); iter2 != m_newLetterCountConstraints.cend () && good; ++iter2) {
-                if (!iter2->satisfies (*iter)) {
-                    //std::cout << "Throwing out " << *iter << " because of " << *iter2 << "\n";
-                    good = false;
+    }
+    return feedback;
+}
+
+/// \brief Pairs whose feedback is easy to get wrong because of repeated letters, with the right feedback for each.
+const std::vector<std::array<std::string, 3>> KNOWN_FEEDBACK = {
+    {"SPEED", "ABIDE", "WWYWY"}, {"EERIE", "RESET", "YGYWW"}, {"RESET", "EERIE", "YGWYW"}, {"ABBEY", "KEBAB", "YYGYW"},
+    {"LOOT", "TOOL", "YGGY"}, {"EEEEE", "RESET", "WGWGW"}, {"LETTER", "TOTTER", "WWGGGG"}, {"ABCDEFG", "GFEDCBA", "YYYGYYY"}
+};
+
+/// \brief Checks both ways of computing feedback, for one length of words, against referenceFeedback ().
+/// \param[in,out] rng The random number generator that makes up the words.
+/// \param[in,out] out Where to describe any that are wrong.
+/// \return The number of pairs that were wrong.
+/// The made-up words only use a few letters, so that most of them repeat some.
+/// Each guess goes through computeFeedbackRow () with enough answers that an AVX2 build uses both its vector and its scalar code.
+template <std::size_t WORD_LENGTH>
+std::size_t
+selfTestFeedback (std::mt19937& rng, std::ostream& out) {
+    std::vector<std::pair<std::string, std::vector<std::string>>> cases;
+    for (const std::array<std::string, 3>& known : KNOWN_FEEDBACK) {
+        if (known[0].length () == WORD_LENGTH) { cases.push_back ({known[0], std::vector<std::string> (19, known[1])}); }
+    }
+    const std::string LETTERS = "AEST";
+    auto randomWord = [&] () {
+        std::string word (WORD_LENGTH, ' ');
+        for (char& c : word) { c = LETTERS[std::uniform_int_distribution<std::size_t> (0, LETTERS.length () - 1) (rng)]; }
+        return word;
+    };
+    for (std::size_t c = 0; c < 500; ++c) {
+        cases.push_back ({randomWord (), {}});
+        for (std::size_t a = 0; a < 19; ++a) { cases.back ().second.push_back (randomWord ()); }
+    }
+    std::size_t wrong = 0;
+    for (const std::array<std::string, 3>& known : KNOWN_FEEDBACK) {
+        if (known[0].length () == WORD_LENGTH && referenceFeedback (known[0], known[1]) != known[2]) {
+            out << "The reference gets " << known[0] << " against " << known[1] << " wrong\n";
+            ++wrong;
+        }
+    }
+    for (const std::pair<std::string, std::vector<std::string>>& test : cases) {
+        Word<WORD_LENGTH> guess (test.first);
+        std::vector<Word<WORD_LENGTH>> answers (test.second.begin (), test.second.end ());
+        std::vector<Pattern<WORD_LENGTH>> row (answers.size ());
+        computeFeedbackRow (guess, answers.data (), answers.size (), row.data ());
+        for (std::size_t a = 0; a < answers.size (); ++a) {
+            std::string expected = referenceFeedback (test.first, test.second[a]);
+            std::string single = patternToString<WORD_LENGTH> (computeFeedback (guess, answers[a]));
+            std::string inRow = patternToString<WORD_LENGTH> (row[a]);
+            if (single != expected || inRow != expected) {
+                if (++wrong <= 10) {
+                    out << test.first << " against " << test.second[a] << " should be " << expected << " but was " << single
+                        << " on its own and " << inRow << " in a row\n";
                 }
             }
-            if (!good) { iter = candidates.erase (iter); }
-            else { ++iter; }
         }
-        m_finishedPositionConstraints.merge (m_newPositionConstraints);
-        assert (m_newPositionConstraints.size () == 0);
-        m_finishedLetterCountConstraints.merge (m_newLetterCountConstraints);
-        assert (m_newLetterCountConstraints.size () == 0);
     }
+    return wrong;
+}
 
-    void
-    addPositionConstraint (const PositionConstraint& c) {
-        if (m_finishedPositionConstraints.count (c) == 0) {
-            m_newPositionConstraints.insert (c);
-        }
+/// \brief Checks the feedback kernels for every length of words.
+/// \param[in,out] out Where to say how it went.
+/// \return True if they all agree with referenceFeedback ().
+inline bool
+selfTest (std::ostream& out) {
+    std::mt19937 rng (1);
+    std::size_t wrong = selfTestFeedback<4> (rng, out) + selfTestFeedback<5> (rng, out) + selfTestFeedback<6> (rng, out)
+                        + selfTestFeedback<7> (rng, out);
+    bool vector = false;
+#if defined(__AVX2__)
+    vector = true;
+#endif
+    out << "Feedback self-test " << (wrong == 0 ? "passed" : "FAILED") << (vector ? " (with AVX2)" : " (without AVX2)");
+    if (wrong != 0) { out << ": " << wrong << " pairs wrong"; }
+    out << "\n";
+    return wrong == 0;
+}
+
+
+/// \brief Finds out what length of words a dictionary file is for.
+/// \param[in] fileName The name of the file.
+/// \return The length recorded in a preprocessed dictionary, or the length of the first word of a plain word list,
+///   or 0 if that is not a length we can play (or the file cannot be read).
+std::size_t
+dictionaryWordLength (const std::string& fileName) {
+    std::ifstream in (fileName, std::ios::binary);
+    DictionaryHeader header;
+    if (in.read (reinterpret_cast<char*> (&header), sizeof (header))
+        && std::memcmp (header.m_magic, DICTIONARY_MAGIC, sizeof (DICTIONARY_MAGIC)) == 0) {
+        return header.m_wordLength;
+    }
+    in.clear ();
+    in.seekg (0);
+    std::string first;
+    if (!(in >> first) || first.length () < MIN_WORD_LENGTH || first.length () > MAX_WORD_LENGTH
+        || !std::all_of (first.begin (), first.end (), [] (char c) { return std::isalpha (static_cast<unsigned char> (c)); })) {
+        return 0;
     }
+    return first.length ();
+}
 
-    void
-    addLetterCountConstraint (const LetterCountConstraint& c) {
-        if (m_finishedLetterCountConstraints.count (c) == 0) {
-            m_newLetterCountConstraints.insert (c);
-        }
+
+/// \brief Plays a multi-board game on the console, or benchmarks multi-board games, as the command line asked.
+/// \param[in] words The word lists.
+/// \param[in] strategy The way of scoring guesses.
+/// \param[in] patterns The feedback for every allowed guess against every answer.
+/// \param[in] options The settings from the command line.
+/// \return The exit status for the program.
+template <std::size_t WORD_LENGTH>
+int
+runMultiBoard (const WordCollection<WORD_LENGTH>& words, const ScoringStrategy<WORD_LENGTH>& strategy, const PatternMatrix<WORD_LENGTH>& patterns,
+               const Options& options) {
+    if (options.bench) {
+        std::size_t numGames = options.sampleSize != 0 ? options.sampleSize : DEFAULT_MULTI_BOARD_GAMES;
+        runMultiBoardBenchmark (words, strategy, patterns, options.numBoards, numGames, options.seed, options.numThreads, std::cout);
+        return 0;
     }
+    std::mt19937 rng (options.seed);
+    MultiBoardState<WORD_LENGTH> game (words, options.numBoards);
+    int numGuesses = 0;
 
-private:
-    std::unordered_set<PositionConstraint> m_finishedPositionConstraints;
-    std::unordered_set<LetterCountConstraint> m_finishedLetterCountConstraints;
-    std::unordered_set<PositionConstraint> m_newPositionConstraints;
-    std::unordered_set<LetterCountConstraint> m_newLetterCountConstraints;
-};
+    while (game.numUnsolved () != 0) {
+        ++numGuesses;
+        for (std::size_t board = 0; board < game.numBoards (); ++board) {
+            if (!game.m_solved[board] && game.m_possible[board].none ()) {
+                std::cout << "Either your word on board " << board + 1 << " is not in my dictionary, or you made a mistake.\n";
+                return 0;
+            }
+        }
+        Word<WORD_LENGTH> current_guess = game.chooseGuess (words, strategy, patterns, rng, options.numThreads);
+        std::cout << "You should guess " << current_guess << "\n";
+        for (std::size_t board = 0; board < game.numBoards (); ++board) {
+            if (game.m_solved[board]) { continue; }
+            std::cout << "Enter the response on board " << board + 1 << " like " << std::string (WORD_LENGTH - 1, NOT_THERE) << RIGHT_SPOT << ": ";
+            std::string current_feedback;
+            if (!(std::cin >> current_feedback)) { return 0; }
+            game.applyFeedback (words, board, current_guess, current_feedback);
+            if (game.m_solved[board]) { std::cout << "Board " << board + 1 << " solved in " << numGuesses << " guesses.\n"; }
+        }
+    }
+    std::cout << "Yay, we got all " << game.numBoards () << " in " << numGuesses << " guesses!\n";
+    return 0;
+}
 
 
+/// \brief Does whatever the command line asked for, with words of one particular length.
+/// \param[in] options The settings from the command line.
+/// \return The exit status for the program.
+template <std::size_t WORD_LENGTH>
 int
-main (int argc, char* argv[]) {
-    srand (time(NULL));
-    std::string dictName = DEFAULT_DICT_NAME;
-    if (argc == 2) { dictName = argv[1]; }
-    std::ifstream dict (dictName);
-    WordCollection words (dict);
-    ConstraintCollection constraints;
-    int numGuesses = 0;
+run (const Options& options) {
+    std::vector<Word<WORD_LENGTH>> answers;
+    if (!loadDictionary (options.dictName, answers)) {
+        std::cerr << "Could not read the dictionary " << options.dictName << "\n";
+        return 1;
+    }
+    if (!options.saveDictName.empty ()) {
+        if (!saveDictionary (options.saveDictName, answers)) {
+            std::cerr << "Could not write the dictionary to " << options.saveDictName << "\n";
+            return 1;
+        }
+        std::cerr << "Wrote " << answers.size () << " words to " << options.saveDictName << "\n";
+        return 0;
+    }
+    std::vector<Word<WORD_LENGTH>> extraGuesses;
+    if (!options.guessListName.empty () && !loadDictionary (options.guessListName, extraGuesses)) {
+        std::cerr << "Could not read the list of allowed guesses " << options.guessListName << "\n";
+        return 1;
+    }
+    if (answers.empty ()) {
+        std::cerr << "The dictionary " << options.dictName << " has no " << WORD_LENGTH << "-letter words.\n";
+        return 1;
+    }
+    WordCollection<WORD_LENGTH> loaded (answers, extraGuesses);
+    loaded.m_hardMode = options.hardMode;
+    std::unique_ptr<ScoringStrategy<WORD_LENGTH>> strategy;
+    bool tree = options.strategyName == OPTIMAL_STRATEGY_NAME || options.strategyName == MINIMAX_STRATEGY_NAME;
+    if (options.hardMode && (tree || options.numBoards > 1)) {
+        std::cerr << "Hard mode only works with one board and the frequency, entropy, expected, or worst strategy.\n";
+        return 1;
+    }
+    if (tree && options.numBoards > 1) {
+        std::cerr << "Several boards only work with the frequency, entropy, expected, or worst strategy.\n";
+        return 1;
+    }
+    if (options.strategyName == FREQUENCY_STRATEGY_NAME && options.numBoards > 1) {
+        std::cerr << "Several boards are scored with feedback patterns, so the " << TREE_ORDERING_STRATEGY_NAME << " strategy is used instead of "
+                  << FREQUENCY_STRATEGY_NAME << ".\n";
+    }
+    if (options.strategyName != FREQUENCY_STRATEGY_NAME || options.numBoards > 1) {
+        // Several boards need feedback patterns, and trees only order their guesses by a strategy.
+        bool ordering = tree || options.strategyName == FREQUENCY_STRATEGY_NAME;
+        strategy = makeScoringStrategy<WORD_LENGTH> (ordering ? TREE_ORDERING_STRATEGY_NAME : options.strategyName);
+        if (!strategy) {
+            std::cerr << "Unknown strategy " << options.strategyName << "; try frequency, entropy, expected, worst, optimal, or minimax.\n";
+            return 1;
+        }
+    }
+    std::unique_ptr<PatternMatrix<WORD_LENGTH>> patterns;
+    if (strategy) { patterns = preparePatterns (loaded, options.patternCacheName, options.patternBudget, options.numThreads, std::cerr); }
+    Dictionary<WORD_LENGTH> dictionary (std::move (loaded), std::move (strategy), std::move (patterns), options.numThreads);
+    const WordCollection<WORD_LENGTH>& words = dictionary.words ();
+    if (options.numBoards > 1) { return runMultiBoard (words, *dictionary.strategy (), *dictionary.patterns (), options); }
+    std::unique_ptr<DeviceScorer<WORD_LENGTH>> device;
+    if (options.useDevice && dictionary.strategy ()) { device = DeviceScorer<WORD_LENGTH>::create (words, *dictionary.strategy (), std::cerr); }
+    Solver<WORD_LENGTH>& solver = dictionary.solver ();
+    solver.m_device = device.get ();
+    if (tree) { solver.m_treeName = options.strategyName; }
+    solver.m_shortlistSize = options.shortlistSize;
+    solver.m_sampleStride = options.sampleStride;
+    solver.m_deadline = std::chrono::microseconds (options.deadline);
+    std::uint64_t dictionaryHash = words.hash ();
+    // A hard-mode book can not be used for normal games or the other way around.
+    std::string bookStrategyName = solver.name () + (options.hardMode ? "-hard" : "");
+    if (options.treeWorkerPort != 0) {
+        if (!tree) {
+            std::cerr << "A tree worker needs the optimal or minimax strategy.\n";
+            return 1;
+        }
+        TreeWorker<WORD_LENGTH> worker (words, *dictionary.strategy (), *dictionary.patterns (), options.treeBreadth, options.memoSize, device.get ());
+        return worker.run (options.treeWorkerPort, std::cerr) ? 0 : 1;
+    }
+    std::unique_ptr<RemoteTreeHelpers<WORD_LENGTH>> helpers;
+    if (tree && !options.treeHelpers.empty ()) {
+        helpers.reset (new RemoteTreeHelpers<WORD_LENGTH> (options.treeHelpers, dictionaryHash, options.treeBreadth, options.treeTimeout, std::cerr));
+    }
+    if (options.buildBook && tree) {
+        OpeningBook<WORD_LENGTH> book (dictionaryHash, bookStrategyName);
+        if (!buildDecisionTree (words, *dictionary.strategy (), *dictionary.patterns (), options.strategyName == MINIMAX_STRATEGY_NAME, options.treeBreadth,
+                                options.memoSize, options.numThreads, book, std::cerr, device.get (), helpers.get ())) {
+            return 1;
+        }
+        if (!book.save (options.bookName)) {
+            std::cerr << "Could not write the decision tree to " << options.bookName << "\n";
+            return 1;
+        }
+        std::cerr << "Wrote " << book.size () << " moves to " << options.bookName << "\n";
+        return 0;
+    }
+    if (options.buildBook) {
+        if (options.bookDepth < 1 || options.bookDepth >= OpeningBook<WORD_LENGTH>::MAX_DEPTH) {
+            std::cerr << "The book depth must be from 1 to " << OpeningBook<WORD_LENGTH>::MAX_DEPTH - 1 << ".\n";
+            return 1;
+        }
+        OpeningBook<WORD_LENGTH> book (dictionaryHash, bookStrategyName);
+        std::mt19937 bookRng (options.seed);
+        std::vector<Pattern<WORD_LENGTH>> history;
+        {
+            PROFILE_SCOPE (PHASE_BUILD_BOOK);
+            buildOpeningBook (solver, words, words.start (), Knowledge<WORD_LENGTH> (), history, options.bookDepth, bookRng, book);
+        }
+        if (!book.save (options.bookName)) {
+            std::cerr << "Could not write the opening book to " << options.bookName << "\n";
+            return 1;
+        }
+        std::cerr << "Wrote " << book.size () << " moves to " << options.bookName << "\n";
+        return 0;
+    }
+    std::unique_ptr<OpeningBook<WORD_LENGTH>> book = OpeningBook<WORD_LENGTH>::load (options.bookName, dictionaryHash, bookStrategyName, &words.m_guesses);
+    if (tree && !book) {
+        book.reset (new OpeningBook<WORD_LENGTH> (dictionaryHash, bookStrategyName));
+        if (!buildDecisionTree (words, *dictionary.strategy (), *dictionary.patterns (), options.strategyName == MINIMAX_STRATEGY_NAME, options.treeBreadth,
+                                options.memoSize, options.numThreads, *book, std::cerr, device.get (), helpers.get ())) {
+            return 1;
+        }
+    }
+    solver.m_book = book.get ();
+    if (options.bench) {
+        Solver<WORD_LENGTH> benchSolver = solver;
+        benchSolver.m_numThreads = 1;
+        ShortlistStats shortlistStats;
+        if (benchSolver.m_shortlistSize != 0 && solver.m_strategy) { benchSolver.m_shortlistStats = &shortlistStats; }
+        AnytimeStats anytimeStats;
+        if (benchSolver.m_deadline.count () != 0 && solver.m_strategy) { benchSolver.m_anytimeStats = &anytimeStats; }
+        std::unique_ptr<MemoTable<Word<WORD_LENGTH>>> memo;
+        if (options.memoSize != 0) {
+            memo.reset (new MemoTable<Word<WORD_LENGTH>> (options.memoSize));
+            benchSolver.m_memo = memo.get ();
+        }
+        runBenchmark (benchSolver, words, options.sampleSize, options.seed, options.numThreads, std::cout, [] () { return allocationsOnThisThread; });
+        return 0;
+    }
+    if (options.servePort != 0) {
+        // Each game gets one thread, and there are as many games going at once as threads.
+        solver.m_numThreads = 1;
+        std::unique_ptr<MemoTable<Word<WORD_LENGTH>>> memo;
+        if (options.memoSize != 0) {
+            memo.reset (new MemoTable<Word<WORD_LENGTH>> (options.memoSize));
+            solver.m_memo = memo.get ();
+        }
+        Server<WORD_LENGTH> server (dictionary, options.numThreads, options.seed);
+        return server.run (options.servePort, std::cerr) ? 0 : 1;
+    }
+    if (options.batch) {
+        solver.m_numThreads = 1;
+        std::unique_ptr<MemoTable<Word<WORD_LENGTH>>> memo;
+        if (options.memoSize != 0) {
+            memo.reset (new MemoTable<Word<WORD_LENGTH>> (options.memoSize));
+            solver.m_memo = memo.get ();
+        }
+        auto start = std::chrono::steady_clock::now ();
+        BatchPlayer<WORD_LENGTH> player (dictionary, options.numThreads, options.seed, STDOUT_FILENO);
+        std::size_t count = player.run (STDIN_FILENO);
+        double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+        std::cerr << "Answered " << count << " requests in " << seconds << " seconds (" << count / seconds << " per second)\n";
+        return 0;
+    }
+    std::mt19937 rng (options.seed);
+    GameSession<WORD_LENGTH> game (dictionary);
 
     while (true) {
-        ++numGuesses;
-        if (words.m_possibleWords.empty ()) {
+        if (game.numPossible () == 0) {
             std::cout << "Either your word is not in my dictionary, or you made a mistake.\n";
             break;
         }
-        std::string current_guess = words.bestWord ();
+        Word<WORD_LENGTH> current_guess = game.suggest (rng);
         std::cout << "You should guess " << current_guess << "\n";
-        std::cout << "Enter a response like GYWWG: ";
+        std::cout << "Enter a response like " << std::string (WORD_LENGTH - 1, NOT_THERE) << RIGHT_SPOT << ": ";
         std::string current_feedback;
         std::cin >> current_feedback;
-        if (current_feedback == "GGGGG") {
-            std::cout << "Yay, we got it in " << numGuesses << " guesses!\n";
+        if (current_feedback == std::string (WORD_LENGTH, RIGHT_SPOT)) {
+            std::cout << "Yay, we got it in " << game.numGuesses () + 1 << " guesses!\n";
             break;
         }
-        for (PositionConstraint c : constraints.generatePositionConstraints (current_guess, current_feedback)) {
-            constraints.addPositionConstraint (c);
+        game.observe (current_guess, current_feedback);
+    }
+    return 0;
+}
+
+
+int
+main (int argc, char* argv[]) {
+    Options options;
+    for (int arg = 1; arg < argc; ++arg) {
+        std::string option = argv[arg];
+        if (option == "--patterns" && arg + 1 < argc) { options.patternCacheName = argv[++arg]; }
+        else if (option == "--strategy" && arg + 1 < argc) { options.strategyName = argv[++arg]; }
+        else if (option == "--seed" && arg + 1 < argc) { options.seed = std::strtoul (argv[++arg], nullptr, 10); }
+        else if (option == "--threads" && arg + 1 < argc) { options.numThreads = std::max (1, std::atoi (argv[++arg])); }
+        else if (option == "--bench") { options.bench = true; }
+        else if (option == "--guesses" && arg + 1 < argc) { options.guessListName = argv[++arg]; }
+        else if (option == "--save-dict" && arg + 1 < argc) { options.saveDictName = argv[++arg]; }
+        else if (option == "--book" && arg + 1 < argc) { options.bookName = argv[++arg]; }
+        else if (option == "--build-book") { options.buildBook = true; }
+        else if (option == "--memo-size" && arg + 1 < argc) { options.memoSize = std::strtoul (argv[++arg], nullptr, 10); }
+        else if (option == "--pattern-budget" && arg + 1 < argc) { options.patternBudget = std::strtoull (argv[++arg], nullptr, 10) << 20; }
+        else if (option == "--book-depth" && arg + 1 < argc) { options.bookDepth = std::strtoul (argv[++arg], nullptr, 10); }
+        else if (option == "--tree-breadth" && arg + 1 < argc) { options.treeBreadth = std::strtoul (argv[++arg], nullptr, 10); }
+        else if (option == "--shortlist" && arg + 1 < argc) { options.shortlistSize = std::strtoul (argv[++arg], nullptr, 10); }
+        else if (option == "--sample-stride" && arg + 1 < argc) { options.sampleStride = std::strtoul (argv[++arg], nullptr, 10); }
+        else if (option == "--deadline" && arg + 1 < argc) { options.deadline = std::strtoul (argv[++arg], nullptr, 10); }
+        else if (option == "--serve" && arg + 1 < argc) { options.servePort = std::strtoul (argv[++arg], nullptr, 10); }
+        else if (option == "--batch") { options.batch = true; }
+        else if (option == "--hard") { options.hardMode = true; }
+        else if (option == "--gpu") { options.useDevice = true; }
+        else if (option == "--tree-worker" && arg + 1 < argc) { options.treeWorkerPort = std::strtoul (argv[++arg], nullptr, 10); }
+        else if (option == "--tree-helpers" && arg + 1 < argc) {
+            std::istringstream in (argv[++arg]);
+            for (std::string address; std::getline (in, address, ','); ) { options.treeHelpers.push_back (address); }
+        }
+        else if (option == "--tree-timeout" && arg + 1 < argc) { options.treeTimeout = std::strtoul (argv[++arg], nullptr, 10); }
+        else if (option == "--profile" && arg + 1 < argc) { options.profileName = argv[++arg]; }
+        else if (option == "--boards" && arg + 1 < argc) { options.numBoards = std::max (1ul, std::strtoul (argv[++arg], nullptr, 10)); }
+        else if (option == "--sample" && arg + 1 < argc) { options.sampleSize = std::strtoul (argv[++arg], nullptr, 10); }
+        else if (option == "--length" && arg + 1 < argc) { options.wordLength = std::strtoul (argv[++arg], nullptr, 10); }
+        else if (option == "--self-test") { options.selfTest = true; }
+        else if (option == "--help") {
+            std::cout << USAGE;
+            return 0;
         }
-        for (LetterCountConstraint c : constraints.generateLetterCountConstraints (current_guess, current_feedback)) {
-            constraints.addLetterCountConstraint (c);
+        else if (option.compare (0, 2, "--") == 0) {
+            std::cerr << "Unknown option " << option << ", or it is missing its value.\n" << USAGE;
+            return 1;
         }
-        constraints.processNewConstraints (words.m_possibleWords);
+        else { options.dictName = option; }
     }
-    return 0;
+    if (options.selfTest) { return selfTest (std::cout) ? 0 : 1; }
+    if (options.wordLength == 0) { options.wordLength = dictionaryWordLength (options.dictName); }
+    if (options.wordLength == 0) { options.wordLength = DEFAULT_WORD_LENGTH; }
+    if (!PROFILING && !options.profileName.empty ()) {
+        std::cerr << "This build does not keep a profile; compile with -DCHWORDLEBOT_PROFILE to get one.\n";
+    }
+    int status;
+    switch (options.wordLength) {
+    case 4: status = run<4> (options); break;
+    case 5: status = run<5> (options); break;
+    case 6: status = run<6> (options); break;
+    case 7: status = run<7> (options); break;
+    default:
+        std::cerr << "The length of words must be from " << MIN_WORD_LENGTH << " to " << MAX_WORD_LENGTH << ".\n";
+        return 1;
+    }
+    if (PROFILING) {
+        std::ofstream file;
+        if (!options.profileName.empty ()) { file.open (options.profileName); }
+        (file.is_open () ? file : std::cerr) << profileReport () << "\n";
+    }
+    return status;
 }
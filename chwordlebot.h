@@ -0,0 +1,3960 @@
+/// \file chwordlebot.h
+/// \author Chad Hogg
+/// \version 2026-10-14
+/// The engine that plays Wordle, for any program that wants to play games of its own.
+/// A Dictionary holds the words and everything worked out from them, and is shared by any number of GameSessions,
+///   each of which is one game: ask it for a guess with suggest (), and tell it how that went with observe ().
+/// It can also play and benchmark whole games itself, on one board or several at once.
+/// treeworker.h shares decision-tree searches with other machines, and chwordlebot.cpp is the command line on top of both.
+
+#ifndef CHWORDLEBOT_H
+#define CHWORDLEBOT_H
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <new>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <type_traits>
+#include <chrono>
+#include <cassert>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#ifdef CHWORDLEBOT_OPENCL
+#define CL_TARGET_OPENCL_VERSION 120
+#include <CL/cl.h>
+#endif
+
+/// \brief The length of words we work with if it is not specified and the dictionary does not say.
+const std::size_t DEFAULT_WORD_LENGTH = 5;
+/// \brief The shortest words the engine is built for.
+const std::size_t MIN_WORD_LENGTH = 4;
+/// \brief The longest words the engine is built for.
+const std::size_t MAX_WORD_LENGTH = 7;
+/// \brief The dictionary file that should be used if none is specified.
+const std::string DEFAULT_DICT_NAME = "/usr/share/dict/words";
+/// \brief The file that feedback patterns are cached in if none is specified.
+const std::string DEFAULT_PATTERN_CACHE_NAME = "chwordlebot.patterns";
+/// \brief The file that the opening book is kept in if none is specified.
+const std::string DEFAULT_BOOK_NAME = "chwordlebot.book";
+/// \brief The number of guesses the memo table holds in benchmark mode if not specified.
+const std::size_t DEFAULT_MEMO_SIZE = 1 << 18;
+/// \brief The number of guesses an opening book covers if not specified.
+const std::size_t DEFAULT_BOOK_DEPTH = 3;
+/// \brief The number of guesses the decision-tree search tries at each point if not specified.
+const std::size_t DEFAULT_TREE_BREADTH = 8;
+/// \brief How many seconds a coordinator waits on a tree worker before doing its piece itself if not specified.
+const unsigned int DEFAULT_TREE_TIMEOUT = 600;
+/// \brief How many possible answers the first stage of a shortlisted choice looks at if not specified (one in this many).
+const std::size_t DEFAULT_SAMPLE_STRIDE = 8;
+
+/// \brief A "White" response indicates a letter that does not appear in the word (more times than it already has).
+const char NOT_THERE = 'W';
+/// \brief A "Yellow" response indicates a letter that appears in the word at a different location.
+const char WRONG_SPOT = 'Y';
+/// \brief A "Green" response indicates a letter that appears in the word at its current location.
+const char RIGHT_SPOT = 'G';
+
+/// \brief The number of letters in our alphabet.
+const std::size_t ALPHABET_SIZE = 26;
+/// \brief The number of bits used to store each letter of a packed word.
+const unsigned int BITS_PER_LETTER = 5;
+
+
+/// \brief The parts of the program that profiling builds time separately.
+/// Phases can be inside each other (scoring guesses happens while choosing one), so their times overlap.
+enum ProfilePhase {
+    PHASE_LOAD_DICTIONARY,
+    PHASE_LOAD_PATTERNS,
+    PHASE_BUILD_BOOK,
+    PHASE_CHOOSE_GUESS,
+    PHASE_SCORE_GUESSES,
+    PHASE_APPLY_FEEDBACK,
+    NUM_PROFILE_PHASES
+};
+
+/// \brief The things that profiling builds count.
+enum ProfileCounter {
+    /// \brief Games played to the end in the benchmark.
+    COUNT_GAMES,
+    /// \brief Guesses that came from the opening book or decision tree.
+    COUNT_BOOK_HITS,
+    /// \brief Guesses that came from the memo table.
+    COUNT_MEMO_HITS,
+    /// \brief Feedback that has been applied to a set of possible answers.
+    COUNT_FEEDBACK,
+    /// \brief Possible answers that feedback ruled out.
+    COUNT_WORDS_ELIMINATED,
+    /// \brief Allowed guesses that were scored (against all or some of the possible answers).
+    COUNT_GUESSES_SCORED,
+    /// \brief Possible answers that were looked up in a guess's row of the pattern matrix.
+    COUNT_PATTERN_LOOKUPS,
+    NUM_PROFILE_COUNTERS
+};
+
+#ifdef CHWORDLEBOT_PROFILE
+
+/// \brief Where the time went and how much work was done, which is only kept when CHWORDLEBOT_PROFILE is defined.
+/// Each thread adds to its own totals, so keeping track costs an add (and for phases, two clock reads) and no locking.
+/// The totals of every thread, including ones that have finished, are added up when a report is asked for.
+class Profile {
+public:
+
+    /// \brief Gets the totals for the calling thread.
+    static Profile& forThisThread () {
+        static thread_local Profile profile;
+        return profile;
+    }
+
+    /// \brief Adds to one of the calling thread's counters.
+    void count (ProfileCounter counter, std::uint64_t amount) { add (m_counts[counter], amount); }
+
+    /// \brief Adds a call to one of the calling thread's phases.
+    void time (ProfilePhase phase, std::uint64_t nanoseconds) {
+        add (m_calls[phase], 1);
+        add (m_nanoseconds[phase], nanoseconds);
+    }
+
+    /// \brief Describes the totals of every thread so far, as a JSON object on one line.
+    static std::string report () {
+        std::uint64_t calls[NUM_PROFILE_PHASES], nanoseconds[NUM_PROFILE_PHASES], counts[NUM_PROFILE_COUNTERS];
+        {
+            std::lock_guard<std::mutex> lock (registryMutex ());
+            std::copy (retired ().m_calls, retired ().m_calls + NUM_PROFILE_PHASES, calls);
+            std::copy (retired ().m_nanoseconds, retired ().m_nanoseconds + NUM_PROFILE_PHASES, nanoseconds);
+            std::copy (retired ().m_counts, retired ().m_counts + NUM_PROFILE_COUNTERS, counts);
+            for (const Profile* profile = head (); profile != nullptr; profile = profile->m_next) {
+                for (int phase = 0; phase < NUM_PROFILE_PHASES; ++phase) {
+                    calls[phase] += profile->m_calls[phase].load (std::memory_order_relaxed);
+                    nanoseconds[phase] += profile->m_nanoseconds[phase].load (std::memory_order_relaxed);
+                }
+                for (int counter = 0; counter < NUM_PROFILE_COUNTERS; ++counter) { counts[counter] += profile->m_counts[counter].load (std::memory_order_relaxed); }
+            }
+        }
+        static const char* const PHASE_NAMES[NUM_PROFILE_PHASES] = {
+            "load_dictionary", "load_patterns", "build_book", "choose_guess", "score_guesses", "apply_feedback"
+        };
+        static const char* const COUNTER_NAMES[NUM_PROFILE_COUNTERS] = {
+            "games", "book_hits", "memo_hits", "feedback", "words_eliminated", "guesses_scored", "pattern_lookups"
+        };
+        std::ostringstream out;
+        out << "{\"phases\": {";
+        for (int phase = 0; phase < NUM_PROFILE_PHASES; ++phase) {
+            out << (phase == 0 ? "" : ", ") << "\"" << PHASE_NAMES[phase] << "\": {\"calls\": " << calls[phase]
+                << ", \"seconds\": " << nanoseconds[phase] * 1e-9 << "}";
+        }
+        out << "}, \"counters\": {";
+        for (int counter = 0; counter < NUM_PROFILE_COUNTERS; ++counter) {
+            out << (counter == 0 ? "" : ", ") << "\"" << COUNTER_NAMES[counter] << "\": " << counts[counter];
+        }
+        out << "}}";
+        return out.str ();
+    }
+
+private:
+
+    /// \brief Joins the list of threads' totals.
+    Profile () {
+        std::lock_guard<std::mutex> lock (registryMutex ());
+        m_next = head ();
+        head () = this;
+    }
+
+    /// \brief Leaves the list, passing the totals on so that they are not lost when a worker thread finishes.
+    ~Profile () {
+        if (this == &retired ()) { return; }
+        std::lock_guard<std::mutex> lock (registryMutex ());
+        Profile** link = &head ();
+        while (*link != this) { link = &(*link)->m_next; }
+        *link = m_next;
+        for (int phase = 0; phase < NUM_PROFILE_PHASES; ++phase) {
+            add (retired ().m_calls[phase], m_calls[phase].load (std::memory_order_relaxed));
+            add (retired ().m_nanoseconds[phase], m_nanoseconds[phase].load (std::memory_order_relaxed));
+        }
+        for (int counter = 0; counter < NUM_PROFILE_COUNTERS; ++counter) { add (retired ().m_counts[counter], m_counts[counter].load (std::memory_order_relaxed)); }
+    }
+
+    /// \brief For the totals of threads that have finished, which is never on the list.
+    struct Retired {};
+    explicit Profile (Retired) {}
+
+    /// \brief Adds to a total that only this thread changes, so that it need not be a locked add,
+    ///   but another thread can still read it while a report is made.
+    static void add (std::atomic<std::uint64_t>& total, std::uint64_t amount) {
+        total.store (total.load (std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    static std::mutex& registryMutex () {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    static Profile*& head () {
+        static Profile* first = nullptr;
+        return first;
+    }
+
+    static Profile& retired () {
+        static Profile totals {Retired ()};
+        return totals;
+    }
+
+    std::atomic<std::uint64_t> m_calls[NUM_PROFILE_PHASES] = {};
+    std::atomic<std::uint64_t> m_nanoseconds[NUM_PROFILE_PHASES] = {};
+    std::atomic<std::uint64_t> m_counts[NUM_PROFILE_COUNTERS] = {};
+    Profile* m_next = nullptr;
+};
+
+/// \brief Times a phase from where it is created to the end of the enclosing block.
+class ProfileTimer {
+public:
+    explicit ProfileTimer (ProfilePhase phase) : m_phase (phase), m_start (std::chrono::steady_clock::now ()) {}
+
+    ~ProfileTimer () {
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now () - m_start);
+        Profile::forThisThread ().time (m_phase, elapsed.count ());
+    }
+
+private:
+    ProfilePhase m_phase;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+#define PROFILE_CONCATENATE2(a, b) a##b
+#define PROFILE_CONCATENATE(a, b) PROFILE_CONCATENATE2 (a, b)
+/// \brief Times the rest of the enclosing block as a phase.
+#define PROFILE_SCOPE(phase) ProfileTimer PROFILE_CONCATENATE (profileTimer, __LINE__) (phase)
+/// \brief Adds to a counter.
+#define PROFILE_COUNT(counter, amount) Profile::forThisThread ().count (counter, amount)
+
+#else
+
+#define PROFILE_SCOPE(phase) do {} while (false)
+#define PROFILE_COUNT(counter, amount) do {} while (false)
+
+#endif
+
+/// \brief Tells whether this build keeps a profile.
+constexpr bool PROFILING =
+#ifdef CHWORDLEBOT_PROFILE
+    true;
+#else
+    false;
+#endif
+
+/// \brief Describes where the time went so far, as a JSON object, or says that this build does not keep track.
+inline std::string
+profileReport () {
+#ifdef CHWORDLEBOT_PROFILE
+    return Profile::report ();
+#else
+    return "{\"error\": \"built without CHWORDLEBOT_PROFILE\"}";
+#endif
+}
+
+
+/// \brief A word of WORD_LENGTH uppercase letters, packed into a single integer.
+/// Each letter is stored as a number from 0 ('A') to 25 ('Z') in its own BITS_PER_LETTER-bit field,
+///   with the first letter of the word in the lowest bits.
+/// This is a lot smaller than a std::string, and copying or comparing one is a single integer operation.
+/// Everything that depends on the length of words is a template on it, like this, so that each length gets
+///   loops with a fixed number of iterations, which the compiler unrolls.
+template <std::size_t WORD_LENGTH>
+class Word {
+public:
+
+    /// \brief The type the letters are packed into: 32 bits if they fit, and 64 if not.
+    typedef typename std::conditional<WORD_LENGTH * BITS_PER_LETTER <= 32, std::uint32_t, std::uint64_t>::type Bits;
+    static_assert (WORD_LENGTH * BITS_PER_LETTER <= 64, "Words that long do not fit in 64 bits.");
+
+    /// \brief Creates an empty word, which should be assigned to before it is used.
+    Word () : m_bits (0) {}
+
+    /// \brief Creates a packed word from a string.
+    /// \param[in] str A string of exactly WORD_LENGTH uppercase letters.
+    explicit Word (const std::string& str) : m_bits (0) {
+        assert (str.length () == WORD_LENGTH);
+        for (unsigned short index = 0; index < WORD_LENGTH; ++index) {
+            assert (str[index] >= 'A' && str[index] <= 'Z');
+            m_bits |= Bits (str[index] - 'A') << (index * BITS_PER_LETTER);
+        }
+    }
+
+    /// \brief Gets the alphabet index (0 for 'A' through 25 for 'Z') of one letter.
+    /// \param[in] index The position of the letter within the word.
+    /// \return The alphabet index of the letter in that position.
+    unsigned short code (unsigned short index) const {
+        return (m_bits >> (index * BITS_PER_LETTER)) & ((1u << BITS_PER_LETTER) - 1);
+    }
+
+    /// \brief Gets one letter of the word.
+    /// \param[in] index The position of the letter within the word.
+    /// \return The uppercase letter in that position.
+    char at (unsigned short index) const {
+        return 'A' + code (index);
+    }
+
+    /// \brief Finds which letters appear in the word.
+    /// \return A mask with bit i set if letter i ('A' + i) appears at least once.
+    std::uint32_t letterMask () const {
+        std::uint32_t mask = 0;
+        for (unsigned short index = 0; index < WORD_LENGTH; ++index) { mask |= 1u << code (index); }
+        return mask;
+    }
+
+    /// \brief Unpacks the word.
+    /// \return A string containing the letters of the word.
+    std::string toString () const {
+        std::string str (WORD_LENGTH, ' ');
+        for (unsigned short index = 0; index < WORD_LENGTH; ++index) { str[index] = at (index); }
+        return str;
+    }
+
+    bool operator== (const Word<WORD_LENGTH>& other) const { return m_bits == other.m_bits; }
+    bool operator!= (const Word<WORD_LENGTH>& other) const { return m_bits != other.m_bits; }
+    bool operator< (const Word<WORD_LENGTH>& other) const { return m_bits < other.m_bits; }
+
+    /// \brief The packed letters.
+    Bits m_bits;
+};
+
+template <std::size_t WORD_LENGTH>
+std::ostream& operator<< (std::ostream& out, const Word<WORD_LENGTH>& w) {
+    out << w.toString ();
+    return out;
+}
+
+template <std::size_t WORD_LENGTH>
+struct std::hash<Word<WORD_LENGTH>>
+{
+  std::size_t operator()(const Word<WORD_LENGTH>& w) const
+  {
+    return std::hash<typename Word<WORD_LENGTH>::Bits> () (w.m_bits);
+  }
+};
+
+
+/// \brief A set of small non-negative integers (usually dictionary indices), stored one bit apiece.
+/// Intersecting two of these is one AND per 64 integers, which is much cheaper than testing each member.
+class Bitset {
+public:
+
+    /// \brief Creates a set that can hold 0 through size - 1.
+    /// \param[in] size One more than the largest integer that can be stored.
+    /// \param[in] full True if the set should start with every integer in it; false if it should start empty.
+    explicit Bitset (std::size_t size = 0, bool full = false)
+    : m_size (size), m_blocks ((size + 63) / 64, full ? ~std::uint64_t (0) : 0) {
+        if (full) { clearExtraBits (); }
+    }
+
+    /// \brief Adds an integer to the set.
+    void set (std::size_t index) { m_blocks[index / 64] |= std::uint64_t (1) << (index % 64); }
+
+    /// \brief Removes an integer from the set.
+    void reset (std::size_t index) { m_blocks[index / 64] &= ~(std::uint64_t (1) << (index % 64)); }
+
+    /// \brief Tests whether or not an integer is in the set.
+    bool test (std::size_t index) const { return (m_blocks[index / 64] >> (index % 64)) & 1; }
+
+    /// \brief Counts the integers in the set.
+    std::size_t count () const {
+        std::size_t total = 0;
+        for (std::uint64_t block : m_blocks) { total += __builtin_popcountll (block); }
+        return total;
+    }
+
+    /// \brief Tests whether or not the set is empty.
+    bool none () const {
+        for (std::uint64_t block : m_blocks) {
+            if (block != 0) { return false; }
+        }
+        return true;
+    }
+
+    /// \brief Counts the integers that are in both this set and another.
+    std::size_t countAnd (const Bitset& other) const {
+        assert (m_size == other.m_size);
+        std::size_t total = 0;
+        for (std::size_t block = 0; block < m_blocks.size (); ++block) { total += __builtin_popcountll (m_blocks[block] & other.m_blocks[block]); }
+        return total;
+    }
+
+    /// \brief Removes everything that is not also in another set.
+    Bitset& operator&= (const Bitset& other) {
+        assert (m_size == other.m_size);
+        for (std::size_t block = 0; block < m_blocks.size (); ++block) { m_blocks[block] &= other.m_blocks[block]; }
+        return *this;
+    }
+
+    /// \brief Removes everything that is in another set.
+    Bitset& andNot (const Bitset& other) {
+        assert (m_size == other.m_size);
+        for (std::size_t block = 0; block < m_blocks.size (); ++block) { m_blocks[block] &= ~other.m_blocks[block]; }
+        return *this;
+    }
+
+    bool operator== (const Bitset& other) const { return m_size == other.m_size && m_blocks == other.m_blocks; }
+
+    /// \brief Computes a 64-bit fingerprint of the contents of the set.
+    /// Each block is run through a strong mixing function first, so that similar sets get unrelated fingerprints.
+    std::uint64_t hash () const {
+        std::uint64_t result = m_size;
+        for (std::size_t block = 0; block < m_blocks.size (); ++block) {
+            std::uint64_t x = m_blocks[block] + block * 0x9E3779B97F4A7C15ull;
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+            x ^= x >> 31;
+            result = (result ^ x) * 0x100000001B3ull + (result >> 29);
+        }
+        return result;
+    }
+
+    /// \brief Calls a function on each integer in the set, in increasing order.
+    /// \param[in] func A function taking a std::size_t.
+    template <typename Func>
+    void forEach (Func func) const {
+        for (std::size_t block = 0; block < m_blocks.size (); ++block) {
+            std::uint64_t bits = m_blocks[block];
+            while (bits != 0) {
+                func (block * 64 + __builtin_ctzll (bits));
+                bits &= bits - 1;
+            }
+        }
+    }
+
+    /// \brief Lists the integers in the set.
+    /// \return The integers in increasing order.
+    std::vector<std::uint32_t> indices () const {
+        std::vector<std::uint32_t> result;
+        indices (result);
+        return result;
+    }
+
+    /// \brief Lists the integers in the set, reusing a vector's memory.
+    /// \param[out] result The integers in increasing order.
+    void indices (std::vector<std::uint32_t>& result) const {
+        result.resize (count ());
+        std::size_t next = 0;
+        forEach ([&result, &next] (std::size_t index) { result[next++] = index; });
+    }
+
+    /// \brief Gets one more than the largest integer that can be stored.
+    std::size_t size () const { return m_size; }
+
+private:
+
+    /// \brief Makes sure that the unused bits at the end of the last block are zero.
+    void clearExtraBits () {
+        if (m_size % 64 != 0) { m_blocks.back () &= (std::uint64_t (1) << (m_size % 64)) - 1; }
+    }
+
+    std::size_t m_size;
+    std::vector<std::uint64_t> m_blocks;
+};
+
+
+/// \brief For each fact about a word that feedback could tell us, the set of dictionary words for which it is true.
+/// This is built once, when the dictionary is loaded, so that what we learn can be applied a whole set at a time.
+template <std::size_t WORD_LENGTH>
+class LetterIndex {
+public:
+
+    /// \brief Creates an empty index.
+    LetterIndex () {}
+
+    /// \brief Indexes a dictionary.
+    /// \param[in] dictionary The words, whose positions in this list are what the sets contain.
+    explicit LetterIndex (const std::vector<Word<WORD_LENGTH>>& dictionary) {
+        for (unsigned short index = 0; index < WORD_LENGTH; ++index) {
+            for (std::size_t letter = 0; letter < ALPHABET_SIZE; ++letter) {
+                m_atPosition[index][letter] = Bitset (dictionary.size ());
+            }
+        }
+        for (std::size_t letter = 0; letter < ALPHABET_SIZE; ++letter) {
+            m_atLeast[letter][0] = Bitset (dictionary.size (), true);
+            for (unsigned short count = 1; count <= WORD_LENGTH; ++count) {
+                m_atLeast[letter][count] = Bitset (dictionary.size ());
+            }
+        }
+        for (std::size_t w = 0; w < dictionary.size (); ++w) {
+            unsigned short counts[ALPHABET_SIZE] = {};
+            for (unsigned short index = 0; index < WORD_LENGTH; ++index) {
+                unsigned short letter = dictionary[w].code (index);
+                m_atPosition[index][letter].set (w);
+                ++counts[letter];
+            }
+            for (std::size_t letter = 0; letter < ALPHABET_SIZE; ++letter) {
+                for (unsigned short count = 1; count <= counts[letter]; ++count) {
+                    m_atLeast[letter][count].set (w);
+                }
+            }
+        }
+    }
+
+    /// \brief Gets the words that have a particular letter in a particular position.
+    /// \param[in] index The position.
+    /// \param[in] letter The letter, from 'A' to 'Z'.
+    const Bitset& atPosition (unsigned short index, char letter) const { return m_atPosition[index][letter - 'A']; }
+
+    /// \brief Counts how many times each letter appears in a set of words.
+    /// \param[in] words The set of words.
+    /// \param[out] counts The number of times each letter ('A' + i) appears, counting every copy.
+    /// This adds up the sizes of intersections with the position sets, rather than looking at the words themselves.
+    void countLetters (const Bitset& words, std::uint32_t counts[ALPHABET_SIZE]) const {
+        for (std::size_t letter = 0; letter < ALPHABET_SIZE; ++letter) {
+            counts[letter] = 0;
+            for (unsigned short index = 0; index < WORD_LENGTH; ++index) {
+                counts[letter] += words.countAnd (m_atPosition[index][letter]);
+            }
+        }
+    }
+
+    /// \brief Gets the words that contain at least some number of copies of a letter.
+    /// \param[in] letter The letter, from 'A' to 'Z'.
+    /// \param[in] count The number of copies, from 0 to WORD_LENGTH.
+    const Bitset& atLeast (char letter, unsigned short count) const { return m_atLeast[letter - 'A'][count]; }
+
+private:
+    Bitset m_atPosition[WORD_LENGTH][ALPHABET_SIZE];
+    Bitset m_atLeast[ALPHABET_SIZE][WORD_LENGTH + 1];
+};
+
+
+/// \brief Computes 3 to a power, at compile time.
+constexpr std::size_t
+powerOfThree (std::size_t exponent) {
+    return exponent == 0 ? 1 : 3 * powerOfThree (exponent - 1);
+}
+
+/// \brief The number of distinct feedback patterns (3 to the WORD_LENGTH).
+template <std::size_t WORD_LENGTH>
+constexpr std::size_t NUM_PATTERNS = powerOfThree (WORD_LENGTH);
+
+/// \brief Computes how many bits it takes to write every number below some count, at compile time.
+constexpr unsigned int
+bitsToCount (std::size_t count) {
+    return count <= 1 ? 0 : 1 + bitsToCount ((count + 1) / 2);
+}
+/// \brief A complete feedback response to a guess, encoded as a base-3 number.
+/// The digit for the first letter is the least significant: 0 is NOT_THERE, 1 is WRONG_SPOT, and 2 is RIGHT_SPOT.
+/// Up to five letters it fits in a byte; beyond that it takes two.
+template <std::size_t WORD_LENGTH>
+using Pattern = typename std::conditional<NUM_PATTERNS<WORD_LENGTH> <= 256, std::uint8_t, std::uint16_t>::type;
+/// \brief The pattern you get when every letter is in the right spot.
+template <std::size_t WORD_LENGTH>
+constexpr Pattern<WORD_LENGTH> ALL_RIGHT = NUM_PATTERNS<WORD_LENGTH> - 1;
+
+/// \brief The value of a digit of a pattern in each position: 1, 3, 9, and so on.
+template <std::size_t WORD_LENGTH>
+struct PlaceValues {
+    constexpr PlaceValues () : m_values () {
+        std::size_t value = 1;
+        for (std::size_t index = 0; index < WORD_LENGTH; ++index) {
+            m_values[index] = value;
+            value *= 3;
+        }
+    }
+
+    std::size_t m_values[WORD_LENGTH];
+};
+
+/// \brief The place values for each length, worked out by the compiler.
+template <std::size_t WORD_LENGTH>
+constexpr PlaceValues<WORD_LENGTH> PLACE_VALUES {};
+
+/// \brief Computes the feedback Wordle would give, for a guess that has already been unpacked.
+/// \param[in] guessCodes The alphabet index of each letter of the guess.
+/// \param[in] answer The secret word.
+/// \param[in,out] unmatched Per-letter counts, which must be all zero and are left that way.
+/// \return The feedback pattern.
+/// This is the two-pass algorithm, greens first, done without branches.
+/// The first pass marks the RIGHT_SPOT letters and counts the answer's other letters.
+/// The second pass goes left to right through the rest of the guess: a letter is WRONG_SPOT
+///   if the answer still has an uncounted copy of it, and that copy is then used up.
+/// Only the counts that this answer touched are put back to zero, which is cheaper than clearing them all.
+template <std::size_t WORD_LENGTH>
+inline Pattern<WORD_LENGTH>
+computeFeedback (const unsigned int guessCodes[WORD_LENGTH], const Word<WORD_LENGTH>& answer, unsigned char unmatched[ALPHABET_SIZE]) {
+    const typename Word<WORD_LENGTH>::Bits bits = answer.m_bits;
+    unsigned int answerCodes[WORD_LENGTH];
+    unsigned int green[WORD_LENGTH];
+    for (unsigned short index = 0; index < WORD_LENGTH; ++index) {
+        answerCodes[index] = (bits >> (index * BITS_PER_LETTER)) & ((1u << BITS_PER_LETTER) - 1);
+        green[index] = answerCodes[index] == guessCodes[index];
+        unmatched[answerCodes[index]] += 1 - green[index];
+    }
+    std::size_t result = 0;
+    for (unsigned short index = 0; index < WORD_LENGTH; ++index) {
+        unsigned int yellow = (1 - green[index]) & (unmatched[guessCodes[index]] != 0);
+        unmatched[guessCodes[index]] -= yellow;
+        result += (2 * green[index] + yellow) * PLACE_VALUES<WORD_LENGTH>.m_values[index];
+    }
+    for (unsigned short index = 0; index < WORD_LENGTH; ++index) { unmatched[answerCodes[index]] = 0; }
+    return result;
+}
+
+/// \brief Computes the feedback Wordle would give to one guess for each of a list of answers.
+/// \param[in] guess The word that was guessed.
+/// \param[in] answers The secret words.
+/// \param[in] count The number of answers.
+/// \param[out] patterns For each answer, the feedback pattern.
+/// The guess is only unpacked once, and the per-letter counts are shared by all of the answers.
+/// With AVX2 (and words that pack into 32 bits) it does eight answers at once instead:
+///   copy k of a letter in the guess (counting from the left, skipping RIGHT_SPOT ones) is WRONG_SPOT
+///   exactly when the answer has more than k copies of it outside the RIGHT_SPOT positions,
+///   which is all comparisons and additions.
+template <std::size_t WORD_LENGTH>
+void
+computeFeedbackRow (const Word<WORD_LENGTH>& guess, const Word<WORD_LENGTH>* answers, std::size_t count, Pattern<WORD_LENGTH>* patterns) {
+    unsigned int guessCodes[WORD_LENGTH];
+    for (unsigned short index = 0; index < WORD_LENGTH; ++index) { guessCodes[index] = guess.code (index); }
+    std::size_t a = 0;
+#if defined(__AVX2__)
+    if (sizeof (typename Word<WORD_LENGTH>::Bits) == sizeof (std::uint32_t)) {
+        const __m256i letterMask = _mm256_set1_epi32 ((1u << BITS_PER_LETTER) - 1);
+        __m256i guessLetter[WORD_LENGTH];
+        // earlierCopy[index][other] is all ones if other comes before index and has the same letter in the guess.
+        __m256i earlierCopy[WORD_LENGTH][WORD_LENGTH];
+        for (unsigned short index = 0; index < WORD_LENGTH; ++index) {
+            guessLetter[index] = _mm256_set1_epi32 (guessCodes[index]);
+            for (unsigned short other = 0; other < WORD_LENGTH; ++other) {
+                earlierCopy[index][other] = _mm256_set1_epi32 (other < index && guessCodes[other] == guessCodes[index] ? -1 : 0);
+            }
+        }
+        alignas (32) std::uint32_t results[8];
+        for (; a + 8 <= count; a += 8) {
+            __m256i bits = _mm256_loadu_si256 (reinterpret_cast<const __m256i*> (answers + a));
+            __m256i answerLetter[WORD_LENGTH];
+            __m256i green[WORD_LENGTH];
+            for (unsigned short index = 0; index < WORD_LENGTH; ++index) {
+                answerLetter[index] = _mm256_and_si256 (_mm256_srli_epi32 (bits, index * BITS_PER_LETTER), letterMask);
+                green[index] = _mm256_cmpeq_epi32 (answerLetter[index], guessLetter[index]);
+            }
+            __m256i result = _mm256_setzero_si256 ();
+            for (unsigned short index = 0; index < WORD_LENGTH; ++index) {
+                // Both counts are negative, since each match adds a mask of all ones.
+                __m256i available = _mm256_setzero_si256 ();
+                __m256i usedBefore = _mm256_setzero_si256 ();
+                for (unsigned short other = 0; other < WORD_LENGTH; ++other) {
+                    available = _mm256_add_epi32 (available, _mm256_andnot_si256 (green[other], _mm256_cmpeq_epi32 (answerLetter[other], guessLetter[index])));
+                    usedBefore = _mm256_add_epi32 (usedBefore, _mm256_andnot_si256 (green[other], earlierCopy[index][other]));
+                }
+                __m256i yellow = _mm256_andnot_si256 (green[index], _mm256_cmpgt_epi32 (usedBefore, available));
+                std::uint32_t place = PLACE_VALUES<WORD_LENGTH>.m_values[index];
+                result = _mm256_add_epi32 (result, _mm256_and_si256 (green[index], _mm256_set1_epi32 (2 * place)));
+                result = _mm256_add_epi32 (result, _mm256_and_si256 (yellow, _mm256_set1_epi32 (place)));
+            }
+            _mm256_store_si256 (reinterpret_cast<__m256i*> (results), result);
+            for (unsigned int lane = 0; lane < 8; ++lane) { patterns[a + lane] = results[lane]; }
+        }
+    }
+#endif
+    unsigned char unmatched[ALPHABET_SIZE] = {};
+    for (; a < count; ++a) { patterns[a] = computeFeedback (guessCodes, answers[a], unmatched); }
+}
+
+/// \brief Computes the feedback Wordle would give.
+/// \param[in] guess The word that was guessed.
+/// \param[in] answer The secret word.
+/// \return The feedback pattern.
+/// A letter that appears more times in the guess than in the answer only gets WRONG_SPOT for as many
+///   copies as the answer has left over after the RIGHT_SPOT ones, from left to right.
+template <std::size_t WORD_LENGTH>
+Pattern<WORD_LENGTH>
+computeFeedback (const Word<WORD_LENGTH>& guess, const Word<WORD_LENGTH>& answer) {
+    unsigned int guessCodes[WORD_LENGTH];
+    for (unsigned short index = 0; index < WORD_LENGTH; ++index) { guessCodes[index] = guess.code (index); }
+    unsigned char unmatched[ALPHABET_SIZE] = {};
+    return computeFeedback (guessCodes, answer, unmatched);
+}
+
+/// \brief Converts a feedback pattern into the string a human would type.
+/// \param[in] pattern The pattern.
+/// \return A string like GYWWG.
+template <std::size_t WORD_LENGTH>
+std::string
+patternToString (Pattern<WORD_LENGTH> pattern) {
+    const char letters[3] = {NOT_THERE, WRONG_SPOT, RIGHT_SPOT};
+    std::string str (WORD_LENGTH, ' ');
+    for (unsigned short index = 0; index < WORD_LENGTH; ++index) {
+        str[index] = letters[pattern % 3];
+        pattern /= 3;
+    }
+    return str;
+}
+
+/// \brief Converts a string a human would type into a feedback pattern.
+/// \param[in] feedback A string like GYWWG.
+/// \return The pattern.
+template <std::size_t WORD_LENGTH>
+Pattern<WORD_LENGTH>
+patternFromString (const std::string& feedback) {
+    assert (feedback.length () == WORD_LENGTH);
+    Pattern<WORD_LENGTH> result = 0;
+    for (unsigned short index = WORD_LENGTH; index > 0; --index) {
+        char c = feedback[index - 1];
+        assert (c == NOT_THERE || c == WRONG_SPOT || c == RIGHT_SPOT);
+        result = result * 3 + (c == RIGHT_SPOT ? 2 : (c == WRONG_SPOT ? 1 : 0));
+    }
+    return result;
+}
+
+/// \brief Tests whether a string is feedback that patternFromString () can convert.
+/// \param[in] feedback The string, which might have come from anywhere.
+/// \return True if it is WORD_LENGTH of NOT_THERE, WRONG_SPOT and RIGHT_SPOT; false otherwise.
+template <std::size_t WORD_LENGTH>
+bool
+isFeedbackString (const std::string& feedback) {
+    return feedback.length () == WORD_LENGTH && feedback.find_first_not_of (std::string () + NOT_THERE + WRONG_SPOT + RIGHT_SPOT) == std::string::npos;
+}
+
+/// \brief Tests whether a string is a word that the Word constructor can pack.
+/// \param[in] word The string, which might have come from anywhere.
+/// \return True if it is WORD_LENGTH uppercase letters; false otherwise.
+template <std::size_t WORD_LENGTH>
+bool
+isWordString (const std::string& word) {
+    return word.length () == WORD_LENGTH && std::all_of (word.begin (), word.end (), [] (char c) { return c >= 'A' && c <= 'Z'; });
+}
+
+/// \brief Computes a fingerprint of a list of words, for recognizing cache files that were built from it.
+/// \param[in] words The words, in order.
+/// \return A 64-bit FNV-1a hash of the packed words.
+template <std::size_t WORD_LENGTH>
+std::uint64_t
+hashWords (const std::vector<Word<WORD_LENGTH>>& words) {
+    std::uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash] (std::uint64_t value, unsigned int bytes) {
+        for (unsigned int b = 0; b < bytes; ++b) {
+            hash ^= (value >> (b * 8)) & 0xFF;
+            hash *= 1099511628211ull;
+        }
+    };
+    mix (WORD_LENGTH, 1);
+    mix (words.size (), 8);
+    for (const Word<WORD_LENGTH>& word : words) { mix (word.m_bits, sizeof (word.m_bits)); }
+    return hash;
+}
+
+/// \brief Runs a function on every index in a range, spread across several threads.
+/// \param[in] count The number of indices, which are 0 through count - 1.
+/// \param[in] numThreads The number of threads to use.
+/// \param[in] func A function taking a starting and ending (exclusive) index.
+/// Each thread gets one contiguous chunk of the range.
+template <typename Func>
+void
+parallelForChunks (std::size_t count, unsigned int numThreads, Func func) {
+    if (numThreads <= 1 || count < 2) {
+        func (std::size_t (0), count);
+        return;
+    }
+    numThreads = std::min<std::size_t> (numThreads, count);
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < numThreads; ++t) {
+        std::size_t begin = count * t / numThreads;
+        std::size_t end = count * (t + 1) / numThreads;
+        threads.emplace_back (func, begin, end);
+    }
+    for (std::thread& thread : threads) { thread.join (); }
+}
+
+
+/// \brief Buffers that choosing a guess needs, which keep their memory from one call to the next.
+/// There is one set per thread.  Once they have been reserved for the size of the word lists,
+///   choosing a guess does not allocate anything.
+struct Scratch {
+
+    /// \brief Makes sure that the buffers are big enough for some word lists.
+    /// \param[in] numWords The number of words that might be guessed.
+    void reserve (std::size_t numWords) {
+        m_live.reserve (numWords);
+        m_masks.reserve (numWords);
+        m_scores.reserve (numWords);
+        m_options.reserve (numWords);
+        m_sample.reserve (numWords);
+        m_ranked.reserve (numWords);
+        m_legal.reserve (numWords);
+        if (m_removed.size () < numWords) { m_removed = Bitset (numWords); }
+    }
+
+    /// \brief Gets the buffers for the calling thread.
+    static Scratch& forThisThread () {
+        static thread_local Scratch scratch;
+        return scratch;
+    }
+
+    std::vector<std::uint32_t> m_live;
+    std::vector<std::uint32_t> m_masks;
+    std::vector<std::uint32_t> m_scores;
+    std::vector<std::uint32_t> m_options;
+    std::vector<std::uint32_t> m_sample;
+    std::vector<std::pair<double, std::uint32_t>> m_ranked;
+    std::vector<std::uint32_t> m_legal;
+    /// \brief The words that feedback has just ruled out, which applyFeedback () works out.
+    Bitset m_removed;
+};
+
+
+/// \brief The highest-scoring candidates seen so far, kept in the order they were seen.
+/// Several of these can be filled in by different threads from consecutive chunks of the candidates,
+///   and then merged, giving exactly the same result as one thread looking at every candidate.
+template <typename Score>
+struct BestOptions {
+
+    /// \brief Creates an empty list.
+    BestOptions () : m_score () {}
+
+    /// \brief Considers a candidate.
+    /// \param[in] score The score of the candidate.
+    /// \param[in] candidate The candidate.
+    void offer (Score score, std::uint32_t candidate) {
+        if (score > m_score || m_options.empty ()) {
+            m_options.clear ();
+            m_options.push_back (candidate);
+            m_score = score;
+        }
+        else if (score == m_score) {
+            m_options.push_back (candidate);
+        }
+    }
+
+    /// \brief Combines this with a list that was built from later candidates.
+    /// \param[in] later The other list.
+    void merge (const BestOptions& later) {
+        if (later.m_options.empty ()) { return; }
+        if (m_options.empty () || later.m_score > m_score) { *this = later; }
+        else if (later.m_score == m_score) {
+            m_options.insert (m_options.end (), later.m_options.begin (), later.m_options.end ());
+        }
+    }
+
+    Score m_score;
+    std::vector<std::uint32_t> m_options;
+};
+
+/// \brief Finds the highest-scoring candidate, spreading the scoring across threads.
+/// \param[in] candidates The candidates to consider.
+/// \param[in] numThreads The number of threads to use.
+/// \param[in] scoreFunc A function giving the score of a candidate, where higher is better.
+/// \param[in,out] rng The random number generator used to break ties.
+/// \return The chosen candidate.
+/// Ties are broken randomly, but the tied candidates are always in the same order,
+///   so the same seed gives the same choice no matter how many threads there are.
+/// With one thread, the tied candidates go in this thread's Scratch buffer, so nothing is allocated.
+template <typename Score, typename ScoreFunc>
+std::uint32_t
+chooseBest (const std::vector<std::uint32_t>& candidates, unsigned int numThreads, ScoreFunc scoreFunc, std::mt19937& rng) {
+    assert (!candidates.empty ());
+    if (numThreads <= 1 || candidates.size () < 2) {
+        std::vector<std::uint32_t>& options = Scratch::forThisThread ().m_options;
+        options.clear ();
+        Score bestScore = Score ();
+        for (std::uint32_t candidate : candidates) {
+            Score score = scoreFunc (candidate);
+            if (score > bestScore || options.empty ()) {
+                options.clear ();
+                bestScore = score;
+            }
+            if (score == bestScore) { options.push_back (candidate); }
+        }
+        return options[std::uniform_int_distribution<std::size_t> (0, options.size () - 1) (rng)];
+    }
+    unsigned int numChunks = std::max (1u, std::min<unsigned int> (numThreads, candidates.size ()));
+    std::vector<BestOptions<Score>> chunkBest (numChunks);
+    parallelForChunks (numChunks, numChunks, [&] (std::size_t firstChunk, std::size_t endChunk) {
+        for (std::size_t chunk = firstChunk; chunk < endChunk; ++chunk) {
+            std::size_t begin = candidates.size () * chunk / numChunks;
+            std::size_t end = candidates.size () * (chunk + 1) / numChunks;
+            for (std::size_t c = begin; c < end; ++c) {
+                chunkBest[chunk].offer (scoreFunc (candidates[c]), candidates[c]);
+            }
+        }
+    });
+    for (unsigned int chunk = 1; chunk < numChunks; ++chunk) { chunkBest[0].merge (chunkBest[chunk]); }
+    const std::vector<std::uint32_t>& options = chunkBest[0].m_options;
+    return options[std::uniform_int_distribution<std::size_t> (0, options.size () - 1) (rng)];
+}
+
+
+/// \brief The feedback that every possible guess would get against every possible answer.
+/// This is big (one byte per pair, or two for words longer than five letters), so it can be saved to a file and then memory-mapped by later runs
+///   rather than being recomputed every time.
+/// When it would be too big to keep at all, a matrix can instead work the feedback out each time it is asked for,
+///   which is slower but only needs the word lists.
+template <std::size_t WORD_LENGTH>
+class PatternMatrix {
+public:
+
+    /// \brief Computes the feedback for every pair of words.
+    /// \param[in] guesses The words that might be guessed, which become the rows.
+    /// \param[in] answers The words that might be the answer, which become the columns.
+    /// \param[in] numThreads The number of threads to split the work among.
+    /// Each thread takes some of the rows, and fills them in one tile of answers at a time, so that the answers
+    ///   it is comparing against stay in the L1 cache however long the list is.
+    PatternMatrix (const std::vector<Word<WORD_LENGTH>>& guesses, const std::vector<Word<WORD_LENGTH>>& answers, unsigned int numThreads)
+    : m_numGuesses (guesses.size ()), m_numAnswers (answers.size ()), m_key (makeKey (guesses, answers)),
+      m_storage (guesses.size () * answers.size ()), m_mapping (nullptr), m_mappingLength (0) {
+        m_data = m_storage.data ();
+        parallelForChunks (m_numGuesses, numThreads, [&] (std::size_t begin, std::size_t end) {
+            for (std::size_t tile = 0; tile < m_numAnswers; tile += TILE_ANSWERS) {
+                std::size_t width = std::min (TILE_ANSWERS, m_numAnswers - tile);
+                for (std::size_t g = begin; g < end; ++g) {
+                    computeFeedbackRow (guesses[g], answers.data () + tile, width, m_storage.data () + g * m_numAnswers + tile);
+                }
+            }
+        });
+    }
+
+    /// \brief Sets up a matrix that works out feedback as it is asked for, instead of storing any.
+    /// \param[in] guesses The words that might be guessed, which become the rows.
+    /// \param[in] answers The words that might be the answer, which become the columns.
+    /// \return The matrix, which keeps its own copies of the lists.
+    static std::unique_ptr<PatternMatrix<WORD_LENGTH>>
+    onTheFly (const std::vector<Word<WORD_LENGTH>>& guesses, const std::vector<Word<WORD_LENGTH>>& answers) {
+        std::unique_ptr<PatternMatrix<WORD_LENGTH>> matrix (new PatternMatrix<WORD_LENGTH> ());
+        matrix->m_numGuesses = guesses.size ();
+        matrix->m_numAnswers = answers.size ();
+        matrix->m_key = makeKey (guesses, answers);
+        matrix->m_guesses = guesses;
+        matrix->m_answers = answers;
+        return matrix;
+    }
+
+    /// \brief Works out how much memory a matrix would need to be stored.
+    /// \param[in] numGuesses The number of rows.
+    /// \param[in] numAnswers The number of columns.
+    /// \return The size in bytes.
+    static std::size_t storedSize (std::size_t numGuesses, std::size_t numAnswers) { return numGuesses * numAnswers * sizeof (Pattern<WORD_LENGTH>); }
+
+    PatternMatrix (const PatternMatrix<WORD_LENGTH>&) = delete;
+    PatternMatrix<WORD_LENGTH>& operator= (const PatternMatrix<WORD_LENGTH>&) = delete;
+
+    ~PatternMatrix () {
+        if (m_mapping != nullptr) { munmap (m_mapping, m_mappingLength); }
+    }
+
+    /// \brief Gets a matrix from a cache file if there is a good one, or builds one and tries to cache it if not.
+    /// \param[in] fileName The name of the cache file.
+    /// \param[in] guesses The words that might be guessed.
+    /// \param[in] answers The words that might be the answer.
+    /// \param[in] numThreads The number of threads to use if it needs to be built.
+    /// \return The matrix.
+    /// A cache file that was built from different word lists is ignored and replaced.
+    static std::unique_ptr<PatternMatrix<WORD_LENGTH>>
+    loadOrBuild (const std::string& fileName, const std::vector<Word<WORD_LENGTH>>& guesses, const std::vector<Word<WORD_LENGTH>>& answers, unsigned int numThreads) {
+        PROFILE_SCOPE (PHASE_LOAD_PATTERNS);
+        std::unique_ptr<PatternMatrix<WORD_LENGTH>> matrix = load (fileName, makeKey (guesses, answers), guesses.size (), answers.size ());
+        if (!matrix) {
+            matrix.reset (new PatternMatrix<WORD_LENGTH> (guesses, answers, numThreads));
+            if (!matrix->save (fileName)) {
+                std::cerr << "Could not write feedback patterns to " << fileName << "\n";
+            }
+        }
+        return matrix;
+    }
+
+    /// \brief Memory-maps a matrix from a cache file.
+    /// \param[in] fileName The name of the cache file.
+    /// \param[in] key The fingerprint that the word lists should have.
+    /// \param[in] numGuesses The number of rows the matrix should have.
+    /// \param[in] numAnswers The number of columns the matrix should have.
+    /// \return The matrix, or nullptr if the file does not exist or does not match.
+    static std::unique_ptr<PatternMatrix<WORD_LENGTH>>
+    load (const std::string& fileName, std::uint64_t key, std::size_t numGuesses, std::size_t numAnswers) {
+        int fd = open (fileName.c_str (), O_RDONLY);
+        if (fd < 0) { return nullptr; }
+        struct stat info;
+        std::size_t expectedLength = sizeof (Header) + numGuesses * numAnswers * sizeof (Pattern<WORD_LENGTH>);
+        if (fstat (fd, &info) != 0 || std::size_t (info.st_size) != expectedLength) {
+            close (fd);
+            return nullptr;
+        }
+        void* mapping = mmap (nullptr, expectedLength, PROT_READ, MAP_SHARED, fd, 0);
+        close (fd);
+        if (mapping == MAP_FAILED) { return nullptr; }
+        const Header* header = static_cast<const Header*> (mapping);
+        if (std::memcmp (header->m_magic, MAGIC, sizeof (header->m_magic)) != 0 || header->m_key != key
+            || header->m_numGuesses != numGuesses || header->m_numAnswers != numAnswers) {
+            munmap (mapping, expectedLength);
+            return nullptr;
+        }
+        std::unique_ptr<PatternMatrix<WORD_LENGTH>> matrix (new PatternMatrix<WORD_LENGTH> ());
+        matrix->m_numGuesses = numGuesses;
+        matrix->m_numAnswers = numAnswers;
+        matrix->m_key = key;
+        matrix->m_mapping = mapping;
+        matrix->m_mappingLength = expectedLength;
+        matrix->m_data = reinterpret_cast<const Pattern<WORD_LENGTH>*> (static_cast<const char*> (mapping) + sizeof (Header));
+        return matrix;
+    }
+
+    /// \brief Writes the matrix to a cache file.
+    /// \param[in] fileName The name of the cache file.
+    /// \return True if it worked; false otherwise.
+    /// The file is written under a temporary name and then renamed, so another process never maps half of one.
+    bool
+    save (const std::string& fileName) const {
+        assert (isStored ());
+        std::string tempName = fileName + ".tmp" + std::to_string (getpid ());
+        std::ofstream out (tempName, std::ios::binary);
+        if (!out) { return false; }
+        Header header = {};
+        std::memcpy (header.m_magic, MAGIC, sizeof (header.m_magic));
+        header.m_key = m_key;
+        header.m_numGuesses = m_numGuesses;
+        header.m_numAnswers = m_numAnswers;
+        out.write (reinterpret_cast<const char*> (&header), sizeof (header));
+        out.write (reinterpret_cast<const char*> (m_data), m_numGuesses * m_numAnswers * sizeof (Pattern<WORD_LENGTH>));
+        out.close ();
+        if (!out || std::rename (tempName.c_str (), fileName.c_str ()) != 0) {
+            std::remove (tempName.c_str ());
+            return false;
+        }
+        return true;
+    }
+
+    /// \brief Gets the feedback for one pair of words.
+    /// \param[in] guess The index of the guess.
+    /// \param[in] answer The index of the answer.
+    /// \return The feedback that guess would get if that were the answer.
+    Pattern<WORD_LENGTH> at (std::size_t guess, std::size_t answer) const {
+        return isStored () ? m_data[guess * m_numAnswers + answer] : computeFeedback (m_guesses[guess], m_answers[answer]);
+    }
+
+    /// \brief Gets the feedback for one guess against every answer, which only a stored matrix can do.
+    /// \param[in] guess The index of the guess.
+    /// \return A pointer to numAnswers () patterns.
+    const Pattern<WORD_LENGTH>* row (std::size_t guess) const {
+        assert (isStored ());
+        return m_data + guess * m_numAnswers;
+    }
+
+    /// \brief Calls a function on the feedback for one guess against each of a list of answers, in order.
+    /// \param[in] guess The index of the guess.
+    /// \param[in] answers The indices of the answers.
+    /// \param[in] count The number of answers.
+    /// \param[in] func A function taking a Pattern<WORD_LENGTH>.
+    /// This is how everything that scores guesses reads the matrix, so that it does not matter whether it is stored.
+    template <typename Func>
+    void forEach (std::size_t guess, const std::uint32_t* answers, std::size_t count, Func func) const {
+        if (isStored ()) {
+            const Pattern<WORD_LENGTH>* patterns = m_data + guess * m_numAnswers;
+            for (std::size_t a = 0; a < count; ++a) { func (patterns[answers[a]]); }
+            return;
+        }
+        unsigned int guessCodes[WORD_LENGTH];
+        for (unsigned short index = 0; index < WORD_LENGTH; ++index) { guessCodes[index] = m_guesses[guess].code (index); }
+        unsigned char unmatched[ALPHABET_SIZE] = {};
+        for (std::size_t a = 0; a < count; ++a) { func (computeFeedback (guessCodes, m_answers[answers[a]], unmatched)); }
+    }
+
+    /// \brief Tells whether the patterns are kept in memory (or mapped from a file), rather than worked out as needed.
+    bool isStored () const { return m_data != nullptr; }
+
+    /// \brief Gets the fingerprint of the word lists this matrix was built from.
+    std::uint64_t key () const { return m_key; }
+
+    std::size_t numGuesses () const { return m_numGuesses; }
+    std::size_t numAnswers () const { return m_numAnswers; }
+
+private:
+
+    /// \brief The start of a cache file, which is followed by the patterns themselves in row-major order.
+    /// It is padded to 64 bytes so that rows start on cache-line boundaries.
+    struct Header {
+        char m_magic[8];
+        std::uint64_t m_key;
+        std::uint64_t m_numGuesses;
+        std::uint64_t m_numAnswers;
+        char m_padding[32];
+    };
+
+    /// \brief Identifies a cache file, and which version of the format it has.
+    static constexpr const char* MAGIC = "CHWBPM01";
+    /// \brief How many answers the constructor compares each guess against at a time, which is 16 KB of them.
+    static constexpr std::size_t TILE_ANSWERS = 16384 / sizeof (Word<WORD_LENGTH>);
+
+    /// \brief Combines the fingerprints of both word lists.
+    static std::uint64_t makeKey (const std::vector<Word<WORD_LENGTH>>& guesses, const std::vector<Word<WORD_LENGTH>>& answers) {
+        return hashWords (guesses) * 31 + hashWords (answers);
+    }
+
+    /// \brief Creates an empty matrix, to be filled in by load () or onTheFly ().
+    PatternMatrix () : m_numGuesses (0), m_numAnswers (0), m_key (0), m_data (nullptr), m_mapping (nullptr), m_mappingLength (0) {}
+
+    std::size_t m_numGuesses;
+    std::size_t m_numAnswers;
+    std::uint64_t m_key;
+    /// \brief The patterns, if this matrix was computed rather than loaded.
+    std::vector<Pattern<WORD_LENGTH>> m_storage;
+    /// \brief The patterns, wherever they are.
+    const Pattern<WORD_LENGTH>* m_data;
+    /// \brief The mapped cache file, if this matrix was loaded.
+    void* m_mapping;
+    std::size_t m_mappingLength;
+    /// \brief The word lists, if the patterns are worked out as needed.
+    std::vector<Word<WORD_LENGTH>> m_guesses;
+    std::vector<Word<WORD_LENGTH>> m_answers;
+};
+
+
+/// \brief The fewest feedback-pattern lookups worth spreading a pattern-based strategy across threads.
+const std::size_t PARALLEL_PATTERN_THRESHOLD = 1 << 16;
+
+
+/// \brief A copy of the columns of a PatternMatrix for the answers that are still possible, packed together.
+/// After the first guess only a few answers are left, and they are scattered across each row of the full matrix,
+///   so scoring a guess touches a cache line for nearly every one of them.
+/// Once there are few enough to copy, this gathers them into a small matrix of their own, which scoring then reads straight through.
+/// Later guesses in the same game only leave a subset of those answers, so the copy keeps being used,
+///   and it is packed down again (in place) whenever the answers left are half as many as it has columns.
+/// There is one per thread; it checks that each list of answers is one it covers, so nothing has to tell it when a game ends.
+template <std::size_t WORD_LENGTH>
+class ProjectedPatterns {
+public:
+
+    /// \brief Gets the copy for the calling thread.
+    static ProjectedPatterns<WORD_LENGTH>& forThisThread () {
+        static thread_local ProjectedPatterns<WORD_LENGTH> projected;
+        return projected;
+    }
+
+    /// \brief Makes sure that projecting never has to allocate for some word lists.
+    /// \param[in] numGuesses The number of rows in the full matrix.
+    /// \param[in] numAnswers The number of columns in the full matrix.
+    void reserve (std::size_t numGuesses, std::size_t numAnswers) {
+        m_data.reserve (std::min (numGuesses * numAnswers, MAX_ENTRIES));
+        m_answers.reserve (numAnswers);
+        m_columns.reserve (numAnswers);
+        if (m_columnOf.size () < numAnswers) { m_columnOf.resize (numAnswers, NO_COLUMN); }
+    }
+
+    /// \brief Gets ready to score guesses against some answers, copying their columns if that is worth doing.
+    /// \param[in] source The full matrix.
+    /// \param[in] live The indices of the answers, in increasing order.
+    /// \param[in] numRows How many of the guesses will be scored, since every row gets copied and hard mode may only read a few.
+    /// \param[in] numThreads The number of threads to copy with.
+    /// \return What to hand forEach () in place of live, which is live itself if nothing was copied.
+    const std::vector<std::uint32_t>& project (const PatternMatrix<WORD_LENGTH>& source, const std::vector<std::uint32_t>& live,
+                                               std::size_t numRows, unsigned int numThreads) {
+        m_full = &source;
+        if (source.numGuesses () * live.size () > MAX_ENTRIES || live.size () * MIN_SHRINK > source.numAnswers ()
+            || numRows * 2 < source.numGuesses ()) {
+            m_active = false;
+            return live;
+        }
+        if (!covers (source, live)) { projectFrom (source, live, numThreads); }
+        else if (live.size () * 2 <= m_answers.size ()) { repack (live); }
+        else { return m_columns; }
+        m_columns.resize (live.size ());
+        for (std::size_t c = 0; c < live.size (); ++c) { m_columns[c] = c; }
+        return m_columns;
+    }
+
+    /// \brief Calls a function on the feedback for one guess against each of a list of answers, in order.
+    /// \param[in] guess The index of the guess.
+    /// \param[in] answers What project () returned, or part of it.
+    /// \param[in] count The number of answers.
+    /// \param[in] func A function taking a Pattern<WORD_LENGTH>.
+    template <typename Func>
+    void forEach (std::size_t guess, const std::uint32_t* answers, std::size_t count, Func func) const {
+        if (!m_active) {
+            m_full->forEach (guess, answers, count, func);
+            return;
+        }
+        const Pattern<WORD_LENGTH>* patterns = m_data.data () + guess * m_answers.size ();
+        for (std::size_t a = 0; a < count; ++a) { func (patterns[answers[a]]); }
+    }
+
+private:
+
+    /// \brief The most patterns the copy may hold, which is 8 MB of them.
+    static constexpr std::size_t MAX_ENTRIES = (std::size_t (8) << 20) / sizeof (Pattern<WORD_LENGTH>);
+    /// \brief Copying is only worth it once this small a fraction of the answers is left.
+    static constexpr std::size_t MIN_SHRINK = 4;
+    /// \brief Marks an answer that the copy does not have a column for.
+    static constexpr std::uint32_t NO_COLUMN = UINT32_MAX;
+
+    /// \brief Tests whether the copy has a column for each of some answers, and if so finds them.
+    /// \param[in] source The full matrix.
+    /// \param[in] live The indices of the answers.
+    /// \return True if m_columns now holds the column for each answer.
+    bool covers (const PatternMatrix<WORD_LENGTH>& source, const std::vector<std::uint32_t>& live) {
+        if (m_source != &source || m_key != source.key () || m_answers.empty ()) { return false; }
+        m_columns.resize (live.size ());
+        for (std::size_t a = 0; a < live.size (); ++a) {
+            if (live[a] >= m_columnOf.size () || m_columnOf[live[a]] == NO_COLUMN) { return false; }
+            m_columns[a] = m_columnOf[live[a]];
+        }
+        m_active = true;
+        return true;
+    }
+
+    /// \brief Records which answers the copy has columns for.
+    /// \param[in] live The indices of the answers, in column order.
+    void setAnswers (const std::vector<std::uint32_t>& live) {
+        for (std::uint32_t answer : m_answers) { m_columnOf[answer] = NO_COLUMN; }
+        m_answers.assign (live.begin (), live.end ());
+        for (std::size_t c = 0; c < m_answers.size (); ++c) { m_columnOf[m_answers[c]] = c; }
+    }
+
+    /// \brief Copies the columns for some answers out of the full matrix.
+    /// \param[in] source The full matrix.
+    /// \param[in] live The indices of the answers.
+    /// \param[in] numThreads The number of threads to copy with.
+    void projectFrom (const PatternMatrix<WORD_LENGTH>& source, const std::vector<std::uint32_t>& live, unsigned int numThreads) {
+        if (m_columnOf.size () < source.numAnswers ()) { m_columnOf.resize (source.numAnswers (), NO_COLUMN); }
+        m_source = &source;
+        m_key = source.key ();
+        setAnswers (live);
+        m_data.resize (source.numGuesses () * live.size ());
+        Pattern<WORD_LENGTH>* data = m_data.data ();
+        std::size_t width = live.size ();
+        unsigned int threads = source.numGuesses () * width < PARALLEL_PATTERN_THRESHOLD ? 1 : numThreads;
+        parallelForChunks (source.numGuesses (), threads, [&] (std::size_t begin, std::size_t end) {
+            for (std::size_t g = begin; g < end; ++g) {
+                Pattern<WORD_LENGTH>* out = data + g * width;
+                source.forEach (g, live.data (), width, [&out] (Pattern<WORD_LENGTH> pattern) { *out++ = pattern; });
+            }
+        });
+        m_active = true;
+    }
+
+    /// \brief Packs the copy down to the columns for some of its answers.
+    /// \param[in] live The indices of the answers, whose columns covers () has just put in m_columns.
+    /// Each pattern moves to an earlier place (or stays put), and they are moved in order, so this can be done in place.
+    void repack (const std::vector<std::uint32_t>& live) {
+        std::size_t oldWidth = m_answers.size ();
+        std::size_t width = live.size ();
+        Pattern<WORD_LENGTH>* data = m_data.data ();
+        for (std::size_t g = 0; g < m_source->numGuesses (); ++g) {
+            const Pattern<WORD_LENGTH>* in = data + g * oldWidth;
+            Pattern<WORD_LENGTH>* out = data + g * width;
+            for (std::size_t c = 0; c < width; ++c) { out[c] = in[m_columns[c]]; }
+        }
+        m_data.resize (m_source->numGuesses () * width);
+        setAnswers (live);
+    }
+
+    /// \brief The matrix project () was last given, which forEach () reads when nothing was copied.
+    const PatternMatrix<WORD_LENGTH>* m_full = nullptr;
+    /// \brief The matrix the copy was made from.
+    const PatternMatrix<WORD_LENGTH>* m_source = nullptr;
+    /// \brief The fingerprint of m_source, in case a different matrix is made in the same place.
+    std::uint64_t m_key = 0;
+    /// \brief True if forEach () reads the copy, rather than m_source.
+    bool m_active = false;
+    /// \brief The patterns, a row for each guess and a column for each of m_answers.
+    std::vector<Pattern<WORD_LENGTH>> m_data;
+    /// \brief The indices in m_source of the answers the copy has columns for, in order.
+    std::vector<std::uint32_t> m_answers;
+    /// \brief For each answer in m_source, its column in the copy, or NO_COLUMN.
+    std::vector<std::uint32_t> m_columnOf;
+    /// \brief The columns for the answers project () was last given.
+    std::vector<std::uint32_t> m_columns;
+};
+
+
+/// \brief The type of each count in a histogram of feedback patterns.
+/// It is 32 bits, not 16, because with the on-the-fly patterns a dictionary can have more than 65535 possible answers.
+typedef std::uint32_t BucketCount;
+
+/// \brief A way of judging a guess by how it would split up the possible answers.
+/// Each strategy looks at a histogram of how many of the possible answers would produce each feedback pattern.
+/// A guess that leaves many small groups is better than one that leaves a few large groups,
+///   but there is more than one reasonable way to define "better".
+template <std::size_t WORD_LENGTH>
+class ScoringStrategy {
+public:
+
+    virtual ~ScoringStrategy () = default;
+
+    /// \brief Scores a guess.
+    /// \param[in] buckets How many of the possible answers would give each feedback pattern.
+    /// \param[in] total The number of possible answers (which is the sum of the buckets).
+    /// \return The score, where higher is better.
+    virtual double
+    score (const BucketCount buckets[NUM_PATTERNS<WORD_LENGTH>], std::size_t total) const = 0;
+
+    /// \brief Gives the best score a guess could still get when only some of the answers have been put in buckets.
+    /// \param[in] buckets How many of the answers seen so far would give each feedback pattern.
+    /// \param[in] total The number of possible answers, including the ones not seen yet.
+    /// \return A score that the guess can not beat, however the rest of the answers fall.
+    /// The default never rules anything out.  A strategy whose score can only go down as more answers go into the buckets
+    ///   (with the total fixed) can return the score of the buckets so far.
+    virtual double
+    upperBound (const BucketCount[NUM_PATTERNS<WORD_LENGTH>], std::size_t) const { return HUGE_VAL; }
+
+    /// \brief Gives the score as an OpenCL C expression, so that a DeviceScorer can work it out on a GPU.
+    /// \return The expression, or nullptr if this strategy can only be scored on the CPU.
+    /// It can use the number of answers (total), and these sums over the buckets:
+    ///   logSum (sum of c log2 c, as a float), squareSum (sum of c squared), and largest (the biggest c).
+    virtual const char*
+    deviceScore () const { return nullptr; }
+
+    /// \brief Gets the name used to select this strategy on the command line.
+    virtual std::string
+    name () const = 0;
+};
+
+
+/// \brief Prefers the guess whose feedback carries the most information, in the Shannon sense.
+template <std::size_t WORD_LENGTH>
+class EntropyStrategy : public ScoringStrategy<WORD_LENGTH> {
+public:
+
+    virtual double
+    score (const BucketCount buckets[NUM_PATTERNS<WORD_LENGTH>], std::size_t total) const {
+        // -sum (c/n) log (c/n) = log n - (1/n) sum c log c
+        double sum = 0.0;
+        for (std::size_t pattern = 0; pattern < NUM_PATTERNS<WORD_LENGTH>; ++pattern) {
+            if (buckets[pattern] > 1) { sum += buckets[pattern] * std::log2 (double (buckets[pattern])); }
+        }
+        return std::log2 (double (total)) - sum / total;
+    }
+
+    virtual const char*
+    deviceScore () const { return "log2 ((float) total) - logSum / total"; }
+
+    /// With n fixed, the score is log n - (1/n) sum c log c, and c log c only grows as c does, so the score so far is a bound.
+    virtual double
+    upperBound (const BucketCount buckets[NUM_PATTERNS<WORD_LENGTH>], std::size_t total) const { return score (buckets, total); }
+
+    virtual std::string
+    name () const { return "entropy"; }
+};
+
+
+/// \brief Prefers the guess that leaves the fewest possible answers on average.
+/// If every answer is equally likely, the chance of landing in a bucket is proportional to its size,
+///   so the expected number remaining is the sum of the squared sizes divided by the total.
+template <std::size_t WORD_LENGTH>
+class ExpectedSizeStrategy : public ScoringStrategy<WORD_LENGTH> {
+public:
+
+    virtual double
+    score (const BucketCount buckets[NUM_PATTERNS<WORD_LENGTH>], std::size_t total) const {
+        std::uint64_t sumOfSquares = 0;
+        for (std::size_t pattern = 0; pattern < NUM_PATTERNS<WORD_LENGTH>; ++pattern) {
+            sumOfSquares += std::uint64_t (buckets[pattern]) * buckets[pattern];
+        }
+        return -double (sumOfSquares) / total;
+    }
+
+    virtual const char*
+    deviceScore () const { return "-(float) squareSum / total"; }
+
+    /// Every answer added to a bucket can only make a square bigger.
+    virtual double
+    upperBound (const BucketCount buckets[NUM_PATTERNS<WORD_LENGTH>], std::size_t total) const { return score (buckets, total); }
+
+    virtual std::string
+    name () const { return "expected"; }
+};
+
+
+/// \brief Prefers the guess whose largest bucket is the smallest, so that we are never very unlucky.
+template <std::size_t WORD_LENGTH>
+class WorstCaseStrategy : public ScoringStrategy<WORD_LENGTH> {
+public:
+
+    virtual double
+    score (const BucketCount buckets[NUM_PATTERNS<WORD_LENGTH>], std::size_t) const {
+        BucketCount largest = 0;
+        for (std::size_t pattern = 0; pattern < NUM_PATTERNS<WORD_LENGTH>; ++pattern) {
+            largest = std::max (largest, buckets[pattern]);
+        }
+        return -double (largest);
+    }
+
+    virtual const char*
+    deviceScore () const { return "-(float) largest"; }
+
+    /// The largest bucket can only get larger.
+    virtual double
+    upperBound (const BucketCount buckets[NUM_PATTERNS<WORD_LENGTH>], std::size_t total) const { return score (buckets, total); }
+
+    virtual std::string
+    name () const { return "worst"; }
+};
+
+
+/// \brief The name of the letter-frequency heuristic, which does not need feedback patterns.
+const std::string FREQUENCY_STRATEGY_NAME = "frequency";
+/// \brief The name of the decision-tree search that minimizes the average number of guesses.
+const std::string OPTIMAL_STRATEGY_NAME = "optimal";
+/// \brief The name of the decision-tree search that minimizes the most guesses any answer takes.
+const std::string MINIMAX_STRATEGY_NAME = "minimax";
+/// \brief The strategy that decides which guesses the decision-tree search tries,
+///   and that chooses guesses if a game ever leaves the tree.
+const std::string TREE_ORDERING_STRATEGY_NAME = "entropy";
+
+/// \brief Creates a scoring strategy from its name.
+/// \param[in] name The name of a strategy ("entropy", "expected", or "worst").
+/// \return The strategy, or nullptr if there is none by that name.
+template <std::size_t WORD_LENGTH>
+std::unique_ptr<ScoringStrategy<WORD_LENGTH>>
+makeScoringStrategy (const std::string& name) {
+    if (name == "entropy") { return std::unique_ptr<ScoringStrategy<WORD_LENGTH>> (new EntropyStrategy<WORD_LENGTH> ()); }
+    if (name == "expected") { return std::unique_ptr<ScoringStrategy<WORD_LENGTH>> (new ExpectedSizeStrategy<WORD_LENGTH> ()); }
+    if (name == "worst") { return std::unique_ptr<ScoringStrategy<WORD_LENGTH>> (new WorstCaseStrategy<WORD_LENGTH> ()); }
+    return nullptr;
+}
+
+
+/// \brief A whole file, memory-mapped read-only.
+class MappedFile {
+public:
+
+    MappedFile () : m_data (nullptr), m_size (0) {}
+    MappedFile (const MappedFile&) = delete;
+    MappedFile& operator= (const MappedFile&) = delete;
+    ~MappedFile () { if (m_data != nullptr) { munmap (m_data, m_size); } }
+
+    /// \brief Maps a file.
+    /// \param[in] fileName The name of the file.
+    /// \return True if it worked (including if the file is empty); false otherwise.
+    bool open (const std::string& fileName) {
+        int fd = ::open (fileName.c_str (), O_RDONLY);
+        if (fd < 0) { return false; }
+        struct stat info;
+        bool good = fstat (fd, &info) == 0;
+        if (good && info.st_size > 0) {
+            void* mapping = mmap (nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) { good = false; }
+            else {
+                m_data = mapping;
+                m_size = info.st_size;
+                madvise (m_data, m_size, MADV_SEQUENTIAL);
+            }
+        }
+        close (fd);
+        return good;
+    }
+
+    const char* data () const { return static_cast<const char*> (m_data); }
+    std::size_t size () const { return m_size; }
+
+private:
+    void* m_data;
+    std::size_t m_size;
+};
+
+
+/// \brief Splits a word list into words, keeping the ones we can use.
+/// \param[in] begin The first character of the list.
+/// \param[in] end One past the last character of the list.
+/// \return The words that are exactly WORD_LENGTH letters long, converted to uppercase, in the order they appear.
+/// Words are separated by whitespace, and any word containing something other than a letter is skipped.
+/// Every byte goes through one table lookup that says whether it is whitespace, a letter (and which), or junk,
+///   and each word is packed as it is scanned, so nothing is ever copied into a std::string.
+template <std::size_t WORD_LENGTH>
+std::vector<Word<WORD_LENGTH>>
+parseWordList (const char* begin, const char* end) {
+    static const unsigned char SPACE = ALPHABET_SIZE;
+    static const unsigned char JUNK = ALPHABET_SIZE + 1;
+    static const std::vector<unsigned char> classes = [] () {
+        std::vector<unsigned char> table (256, JUNK);
+        for (unsigned char c : std::string (" \t\n\v\f\r")) { table[c] = SPACE; }
+        for (unsigned char letter = 0; letter < ALPHABET_SIZE; ++letter) {
+            table['A' + letter] = letter;
+            table['a' + letter] = letter;
+        }
+        return table;
+    } ();
+
+    typedef typename Word<WORD_LENGTH>::Bits Bits;
+    std::vector<Word<WORD_LENGTH>> words;
+    std::size_t length = 0;
+    unsigned char worst = 0;
+    Bits bits = 0;
+    for (const char* p = begin; p != end; ++p) {
+        unsigned char c = classes[static_cast<unsigned char> (*p)];
+        if (c == SPACE) {
+            if (length == WORD_LENGTH && worst < ALPHABET_SIZE) { words.emplace_back (); words.back ().m_bits = bits; }
+            length = 0;
+            worst = 0;
+            bits = 0;
+            continue;
+        }
+        worst = std::max (worst, c);
+        bits |= length < WORD_LENGTH ? Bits (c) << (length * BITS_PER_LETTER) : 0;
+        ++length;
+    }
+    if (length == WORD_LENGTH && worst < ALPHABET_SIZE) { words.emplace_back (); words.back ().m_bits = bits; }
+    return words;
+}
+
+
+/// \brief The start of a preprocessed dictionary file, which is followed by the packed words themselves.
+/// The words are sorted and have no duplicates, so they can be used exactly as they are.
+struct DictionaryHeader {
+    char m_magic[8];
+    std::uint32_t m_wordLength;
+    std::uint32_t m_bitsPerLetter;
+    std::uint64_t m_numWords;
+    /// \brief The result of hashWords () on the words, to catch truncated or damaged files.
+    std::uint64_t m_checksum;
+};
+
+/// \brief Identifies a preprocessed dictionary file, and which version of the format it has.
+const char DICTIONARY_MAGIC[8] = {'C', 'H', 'W', 'B', 'D', 'I', 'C', '1'};
+
+/// \brief Reads a dictionary, which may be either a plain word list or a preprocessed one.
+/// \param[in] fileName The name of the file.
+/// \param[out] words The words, sorted and without duplicates.
+/// \return True if it worked; false if the file could not be read or is a damaged preprocessed file.
+template <std::size_t WORD_LENGTH>
+bool
+loadDictionary (const std::string& fileName, std::vector<Word<WORD_LENGTH>>& words) {
+    PROFILE_SCOPE (PHASE_LOAD_DICTIONARY);
+    MappedFile file;
+    if (!file.open (fileName)) { return false; }
+    if (file.size () >= sizeof (DictionaryHeader) && std::memcmp (file.data (), DICTIONARY_MAGIC, sizeof (DICTIONARY_MAGIC)) == 0) {
+        DictionaryHeader header;
+        std::memcpy (&header, file.data (), sizeof (header));
+        if (header.m_wordLength != WORD_LENGTH || header.m_bitsPerLetter != BITS_PER_LETTER
+            || file.size () != sizeof (header) + header.m_numWords * sizeof (Word<WORD_LENGTH>)) {
+            return false;
+        }
+        words.resize (header.m_numWords);
+        std::memcpy (words.data (), file.data () + sizeof (header), header.m_numWords * sizeof (Word<WORD_LENGTH>));
+        return hashWords (words) == header.m_checksum;
+    }
+    words = parseWordList<WORD_LENGTH> (file.data (), file.data () + file.size ());
+    std::sort (words.begin (), words.end ());
+    words.erase (std::unique (words.begin (), words.end ()), words.end ());
+    return true;
+}
+
+/// \brief Writes a preprocessed dictionary, which later runs can load without parsing.
+/// \param[in] fileName The name of the file.
+/// \param[in] words The words, which must be sorted and without duplicates.
+/// \return True if it worked; false otherwise.
+template <std::size_t WORD_LENGTH>
+bool
+saveDictionary (const std::string& fileName, const std::vector<Word<WORD_LENGTH>>& words) {
+    assert (std::is_sorted (words.begin (), words.end ()));
+    DictionaryHeader header = {};
+    std::memcpy (header.m_magic, DICTIONARY_MAGIC, sizeof (DICTIONARY_MAGIC));
+    header.m_wordLength = WORD_LENGTH;
+    header.m_bitsPerLetter = BITS_PER_LETTER;
+    header.m_numWords = words.size ();
+    header.m_checksum = hashWords (words);
+    std::ofstream out (fileName, std::ios::binary);
+    out.write (reinterpret_cast<const char*> (&header), sizeof (header));
+    out.write (reinterpret_cast<const char*> (words.data ()), words.size () * sizeof (Word<WORD_LENGTH>));
+    return bool (out);
+}
+
+
+/// \brief Scores words by the letter-frequency heuristic, several at a time where the processor allows.
+/// \param[in] masks For each word, the mask of letters that appear in it (see Word::letterMask ()).
+/// \param[in] count The number of words.
+/// \param[in] frequencies The weight of each letter.
+/// \param[out] scores For each word, the sum of the weights of the distinct letters in it.
+/// This is a dot product of each word's letter mask with the weights.
+/// Rather than testing 26 bits one at a time, the mask is cut into four 7-bit pieces, and each piece is looked up
+///   in a table of the total weight of every subset of those 7 letters.
+/// With AVX2 it does eight words at once, with one gather per piece; otherwise (or for any left over) it does one at a time,
+///   which is only four loads and adds per word anyway.
+inline void
+scoreLetterMasks (const std::uint32_t* masks, std::size_t count, const std::uint32_t frequencies[ALPHABET_SIZE], std::uint32_t* scores) {
+    const unsigned int PIECE_BITS = 7;
+    const std::uint32_t PIECE_SIZE = 1u << PIECE_BITS;
+    alignas (32) std::uint32_t subsetWeights[4][PIECE_SIZE];
+    for (unsigned int piece = 0; piece < 4; ++piece) {
+        subsetWeights[piece][0] = 0;
+        for (std::uint32_t subset = 1; subset < PIECE_SIZE; ++subset) {
+            std::size_t letter = piece * PIECE_BITS + __builtin_ctz (subset);
+            subsetWeights[piece][subset] = subsetWeights[piece][subset & (subset - 1)] + (letter < ALPHABET_SIZE ? frequencies[letter] : 0);
+        }
+    }
+    std::size_t w = 0;
+#if defined(__AVX2__)
+    const __m256i low = _mm256_set1_epi32 (PIECE_SIZE - 1);
+    for (; w + 8 <= count; w += 8) {
+        __m256i mask = _mm256_loadu_si256 (reinterpret_cast<const __m256i*> (masks + w));
+        __m256i total = _mm256_i32gather_epi32 (reinterpret_cast<const int*> (subsetWeights[0]), _mm256_and_si256 (mask, low), 4);
+        for (unsigned int piece = 1; piece < 4; ++piece) {
+            __m256i index = _mm256_and_si256 (_mm256_srli_epi32 (mask, piece * PIECE_BITS), low);
+            total = _mm256_add_epi32 (total, _mm256_i32gather_epi32 (reinterpret_cast<const int*> (subsetWeights[piece]), index, 4));
+        }
+        _mm256_storeu_si256 (reinterpret_cast<__m256i*> (scores + w), total);
+    }
+#endif
+    for (; w < count; ++w) {
+        std::uint32_t mask = masks[w];
+        scores[w] = subsetWeights[0][mask & (PIECE_SIZE - 1)] + subsetWeights[1][(mask >> PIECE_BITS) & (PIECE_SIZE - 1)]
+                  + subsetWeights[2][(mask >> (2 * PIECE_BITS)) & (PIECE_SIZE - 1)] + subsetWeights[3][mask >> (3 * PIECE_BITS)];
+    }
+}
+
+
+/// \brief Which of a WordCollection's words are still in play in one game, which is all that changes as the game goes.
+/// Keeping this apart from the word lists lets any number of games share one WordCollection, each with its own LiveWords.
+/// It is two bitsets and a small array, so copying one (to look ahead, say) is cheap, and copying one over another
+///   of the same collection allocates nothing.
+struct LiveWords {
+
+    /// \brief The indices (in m_answers) of the words that might still be the answer.
+    /// applyFeedback () removes things from it.
+    Bitset m_possibleWords;
+
+    /// \brief How many times each letter ('A' + i) appears in the words that might still be the answer, counting every copy.
+    /// Whatever changes m_possibleWords has to keep this in step, which applyFeedback () does with WordCollection::forgetWords ().
+    std::uint32_t m_letterCounts[ALPHABET_SIZE];
+
+    /// \brief In hard mode, the indices (in m_guesses) of the words that may still be guessed.
+    /// applyFeedback () narrows this with the same kind of set operations that it uses on m_possibleWords.
+    Bitset m_legalGuesses;
+};
+
+
+/// \brief A group of words that are potential solutions to a puzzle.
+/// Nothing about it changes during a game; what does is kept in a LiveWords, which every method that cares about
+///   the words still in play takes.
+template <std::size_t WORD_LENGTH>
+class WordCollection {
+public:
+
+    /// \brief Creates a new collection of words from lists that have already been read.
+    /// \param[in] answers The words that might be the answer, which need not be sorted.
+    /// \param[in] extraGuesses Words that are allowed as guesses but will never be the answer.
+    /// Every answer is also allowed as a guess, so when there are no extra guesses the two lists are the same.
+    explicit WordCollection (const std::vector<Word<WORD_LENGTH>>& answers, const std::vector<Word<WORD_LENGTH>>& extraGuesses = {})
+    : m_answers (answers) {
+        finishLoading (extraGuesses);
+    }
+
+    /// \brief Chooses the best word to guess.
+    /// \param[in] inPlay The words that are still in play in this game.
+    /// \param[in,out] rng The random number generator used to break ties.
+    /// \return A word from the collection.
+    /// It is assumed that by this point only words that are consistent with out knowledge so far are in play.
+    /// This uses a heuristc that we would like to include in our guess letters that provide more information,
+    ///   and specifically that letter that appear more frequently in our pool of possible guesses are better
+    ///   to use than those that appear less frequently.
+    /// Unlike the pattern-based version, this only guesses words that might be the answer,
+    ///   because a letter we already know is in the answer is as frequent as a letter can be
+    ///   and so the heuristic would keep asking about it.
+    /// The letter counts are kept up to date as words are ruled out, and the scores come from scoreLetterMasks (),
+    ///   which is fast enough that splitting the work across threads would only slow it down.
+    /// If multiple words are equally good, it selects between them randomly.
+    Word<WORD_LENGTH> bestWord (const LiveWords& inPlay, std::mt19937& rng) const
+    {
+        PROFILE_SCOPE (PHASE_SCORE_GUESSES);
+        Scratch& scratch = Scratch::forThisThread ();
+        std::vector<std::uint32_t>& live = scratch.m_live;
+        std::vector<std::uint32_t>& masks = scratch.m_masks;
+        live.resize (inPlay.m_possibleWords.count ());
+        masks.resize (live.size ());
+        std::size_t next = 0;
+        inPlay.m_possibleWords.forEach ([&] (std::size_t w) {
+            live[next] = w;
+            masks[next] = m_letterMasks[w];
+            ++next;
+        });
+        std::vector<std::uint32_t>& scores = scratch.m_scores;
+        scores.resize (live.size ());
+        scoreLetterMasks (masks.data (), masks.size (), inPlay.m_letterCounts, scores.data ());
+        PROFILE_COUNT (COUNT_GUESSES_SCORED, live.size ());
+        std::uint32_t bestScore = *std::max_element (scores.begin (), scores.end ());
+        std::vector<std::uint32_t>& bestOptions = scratch.m_options;
+        bestOptions.clear ();
+        for (std::size_t w = 0; w < live.size (); ++w) {
+            if (scores[w] == bestScore) { bestOptions.push_back (live[w]); }
+        }
+        return m_answers[bestOptions[std::uniform_int_distribution<std::size_t> (0, bestOptions.size () - 1) (rng)]];
+    }
+
+    /// \brief Chooses the best word to guess, according to how it would split up the remaining words.
+    /// \param[in] inPlay The words that are still in play in this game.
+    /// \param[in] strategy The way of scoring each potential guess.
+    /// \param[in] patterns The feedback for every allowed guess against every answer.
+    /// \param[in,out] rng The random number generator used to break ties.
+    /// \param[in] numThreads The number of threads to score candidates with.
+    /// \return A word from the list of allowed guesses.
+    /// Every allowed guess is considered, whether or not it could be the answer,
+    ///   so the cost is proportional to the number of allowed guesses times the number of possible answers.
+    /// In hard mode only the guesses that are still legal are considered.
+    /// Between equally good guesses, one that might be the answer is preferred, since it might win outright.
+    /// If multiple words are still equally good, it selects between them randomly.
+    Word<WORD_LENGTH> bestWord (const LiveWords& inPlay, const ScoringStrategy<WORD_LENGTH>& strategy, const PatternMatrix<WORD_LENGTH>& patterns,
+                                std::mt19937& rng, unsigned int numThreads = 1) const
+    {
+        return bestWordAmong (inPlay, strategy, patterns, guessCandidates (inPlay), rng, numThreads);
+    }
+
+    /// \brief Chooses the best word to guess from some of the allowed guesses, the way bestWord () does from all of them.
+    /// \param[in] inPlay The words that are still in play in this game.
+    /// \param[in] strategy The way of scoring each potential guess.
+    /// \param[in] patterns The feedback for every allowed guess against every answer.
+    /// \param[in] candidates The indices of the guesses to consider, in increasing order.
+    /// \param[in,out] rng The random number generator used to break ties.
+    /// \param[in] numThreads The number of threads to score candidates with.
+    /// \return A word from the list of allowed guesses.
+    /// If the candidates include every guess that bestWord () might have chosen, this chooses the same one.
+    Word<WORD_LENGTH> bestWordAmong (const LiveWords& inPlay, const ScoringStrategy<WORD_LENGTH>& strategy, const PatternMatrix<WORD_LENGTH>& patterns,
+                                     const std::vector<std::uint32_t>& candidates, std::mt19937& rng, unsigned int numThreads) const
+    {
+        assert (patterns.numGuesses () == m_guesses.size () && patterns.numAnswers () == m_answers.size ());
+        PROFILE_SCOPE (PHASE_SCORE_GUESSES);
+        std::vector<std::uint32_t>& live = Scratch::forThisThread ().m_live;
+        inPlay.m_possibleWords.indices (live);
+        assert (!live.empty ());
+        if (live.size () == 1) { return m_answers[live[0]]; }
+        PROFILE_COUNT (COUNT_GUESSES_SCORED, candidates.size ());
+        PROFILE_COUNT (COUNT_PATTERN_LOOKUPS, candidates.size () * live.size ());
+        unsigned int threads = live.size () * candidates.size () < PARALLEL_PATTERN_THRESHOLD ? 1 : numThreads;
+        ProjectedPatterns<WORD_LENGTH>& projected = ProjectedPatterns<WORD_LENGTH>::forThisThread ();
+        const std::vector<std::uint32_t>& columns = projected.project (patterns, live, candidates.size (), numThreads);
+        std::uint32_t best = chooseBest<std::pair<double, bool>> (candidates, threads, [&] (std::uint32_t guess) {
+            BucketCount buckets[NUM_PATTERNS<WORD_LENGTH>] = {};
+            projected.forEach (guess, columns.data (), columns.size (), [&buckets] (Pattern<WORD_LENGTH> pattern) { ++buckets[pattern]; });
+            return std::make_pair (strategy.score (buckets, live.size ()), isPossible (inPlay, guess));
+        }, rng);
+        return m_guesses[best];
+    }
+
+    /// \brief Chooses a good word to guess in two stages, which is much faster than bestWord () when there are lots of guesses.
+    /// \param[in] inPlay The words that are still in play in this game.
+    /// \param[in] strategy The way of scoring each potential guess.
+    /// \param[in] patterns The feedback for every allowed guess against every answer.
+    /// \param[in,out] rng The random number generator used to break ties.
+    /// \param[in] numThreads The number of threads to do the first stage with.
+    /// \param[in] shortlistSize The number of guesses that get scored against every possible answer.
+    /// \param[in] sampleStride The first stage looks at one in this many of the possible answers.
+    /// \return A word from the list of allowed guesses.
+    /// First every allowed guess is scored against a sample of the possible answers, and then only the shortlistSize
+    ///   that did best go on to be scored properly, best first.
+    /// Scoring one of those stops as soon as its buckets so far show that it can not beat the best one yet.
+    /// This usually chooses the same guess as bestWord (), but not always, since the best guess might not make the shortlist.
+    /// When there are too few possible answers for a sample to mean much, it just calls bestWord ().
+    Word<WORD_LENGTH> shortlistWord (const LiveWords& inPlay, const ScoringStrategy<WORD_LENGTH>& strategy, const PatternMatrix<WORD_LENGTH>& patterns,
+                                     std::mt19937& rng, unsigned int numThreads, std::size_t shortlistSize, std::size_t sampleStride) const
+    {
+        sampleStride = std::max<std::size_t> (1, sampleStride);
+        const std::vector<std::uint32_t>& candidates = guessCandidates (inPlay);
+        if (shortlistSize == 0 || shortlistSize >= candidates.size () || inPlay.m_possibleWords.count () <= 2) {
+            return bestWord (inPlay, strategy, patterns, rng, numThreads);
+        }
+        PROFILE_SCOPE (PHASE_SCORE_GUESSES);
+        Scratch& scratch = Scratch::forThisThread ();
+        std::vector<std::uint32_t>& live = scratch.m_live;
+        inPlay.m_possibleWords.indices (live);
+        ProjectedPatterns<WORD_LENGTH>& projected = ProjectedPatterns<WORD_LENGTH>::forThisThread ();
+        const std::vector<std::uint32_t>& columns = projected.project (patterns, live, candidates.size (), numThreads);
+        if (live.size () < sampleStride * MIN_SAMPLE_SIZE) { sampleStride = 1; }
+        std::vector<std::uint32_t>& sample = scratch.m_sample;
+        sample.resize ((columns.size () + sampleStride - 1) / sampleStride);
+        for (std::size_t s = 0; s < sample.size (); ++s) { sample[s] = columns[s * sampleStride]; }
+
+        std::vector<std::pair<double, std::uint32_t>>& ranked = scratch.m_ranked;
+        ranked.resize (candidates.size ());
+        PROFILE_COUNT (COUNT_GUESSES_SCORED, candidates.size () + shortlistSize);
+        PROFILE_COUNT (COUNT_PATTERN_LOOKUPS, candidates.size () * sample.size ());
+        unsigned int threads = sample.size () * candidates.size () < PARALLEL_PATTERN_THRESHOLD ? 1 : numThreads;
+        parallelForChunks (candidates.size (), threads, [&] (std::size_t begin, std::size_t end) {
+            for (std::size_t c = begin; c < end; ++c) {
+                std::uint32_t guess = candidates[c];
+                std::uint64_t seen[(NUM_PATTERNS<WORD_LENGTH> + 63) / 64] = {};
+                projected.forEach (guess, sample.data (), sample.size (), [&seen] (Pattern<WORD_LENGTH> pattern) {
+                    seen[pattern / 64] |= std::uint64_t (1) << (pattern % 64);
+                });
+                unsigned int distinct = 0;
+                for (std::uint64_t word : seen) { distinct += __builtin_popcountll (word); }
+                ranked[c] = {double (distinct), guess};
+            }
+        });
+        auto better = [] (const std::pair<double, std::uint32_t>& a, const std::pair<double, std::uint32_t>& b) {
+            return a.first > b.first || (a.first == b.first && a.second < b.second);
+        };
+        std::nth_element (ranked.begin (), ranked.begin () + shortlistSize, ranked.end (), better);
+        std::sort (ranked.begin (), ranked.begin () + shortlistSize, better);
+
+        std::vector<std::uint32_t>& options = scratch.m_options;
+        options.clear ();
+        std::pair<double, bool> bestScore;
+        for (std::size_t r = 0; r < shortlistSize; ++r) {
+            std::uint32_t guess = ranked[r].second;
+            BucketCount buckets[NUM_PATTERNS<WORD_LENGTH>] = {};
+            bool beaten = false;
+            for (std::size_t a = 0; a < columns.size () && !beaten; a += EARLY_EXIT_INTERVAL) {
+                std::size_t end = std::min (columns.size (), a + EARLY_EXIT_INTERVAL);
+                projected.forEach (guess, columns.data () + a, end - a, [&buckets] (Pattern<WORD_LENGTH> pattern) { ++buckets[pattern]; });
+                PROFILE_COUNT (COUNT_PATTERN_LOOKUPS, end - a);
+                beaten = !options.empty () && end < live.size () && strategy.upperBound (buckets, live.size ()) < bestScore.first;
+            }
+            if (beaten) { continue; }
+            std::pair<double, bool> score (strategy.score (buckets, live.size ()), isPossible (inPlay, guess));
+            if (options.empty () || score > bestScore) {
+                options.clear ();
+                bestScore = score;
+            }
+            if (score == bestScore) { options.push_back (guess); }
+        }
+        return m_guesses[options[std::uniform_int_distribution<std::size_t> (0, options.size () - 1) (rng)]];
+    }
+
+    /// \brief Chooses the best word to guess that it can find before a deadline, trying the most promising guesses first.
+    /// \param[in] inPlay The words that are still in play in this game.
+    /// \param[in] strategy The way of scoring each potential guess.
+    /// \param[in] patterns The feedback for every allowed guess against every answer.
+    /// \param[in,out] rng The random number generator used to break ties.
+    /// \param[in] deadline When to stop and settle for the best guess so far.
+    /// \param[out] numEvaluated The number of guesses that were scored against every possible answer
+    ///   (or far enough to show that they could not beat the best one yet).
+    /// \return A word from the list of allowed guesses.
+    /// The guesses are put in order by the letter-frequency heuristic, except that a letter is worth more the more evenly
+    ///   it splits the possible answers, since one that is in all of them tells us as little as one that is in none.
+    /// Then they are scored exactly in that order, the way shortlistWord () scores its shortlist, until time runs out.
+    /// Only as many are sorted as there turns out to be time for, in batches that double in size.
+    /// Everything happens on the calling thread, so the time it takes depends on the deadline and not on how many cores there are.
+    /// At least one guess is always scored, so it can go a little past the deadline.
+    /// If it gets through every guess, the one it chooses is as good as the one bestWord () would have.
+    Word<WORD_LENGTH> anytimeWord (const LiveWords& inPlay, const ScoringStrategy<WORD_LENGTH>& strategy, const PatternMatrix<WORD_LENGTH>& patterns,
+                                   std::mt19937& rng, std::chrono::steady_clock::time_point deadline, std::size_t& numEvaluated) const
+    {
+        assert (patterns.numGuesses () == m_guesses.size () && patterns.numAnswers () == m_answers.size ());
+        PROFILE_SCOPE (PHASE_SCORE_GUESSES);
+        Scratch& scratch = Scratch::forThisThread ();
+        std::vector<std::uint32_t>& live = scratch.m_live;
+        inPlay.m_possibleWords.indices (live);
+        assert (!live.empty ());
+        numEvaluated = 0;
+        if (live.size () == 1) { return m_answers[live[0]]; }
+        const std::vector<std::uint32_t>& candidates = guessCandidates (inPlay);
+        std::uint32_t numLive = live.size ();
+        std::uint32_t weights[ALPHABET_SIZE];
+        for (unsigned short letter = 0; letter < ALPHABET_SIZE; ++letter) {
+            std::uint32_t count = std::min (inPlay.m_letterCounts[letter], numLive);
+            weights[letter] = std::min (count, numLive - count);
+        }
+        std::vector<std::uint32_t>& masks = scratch.m_masks;
+        masks.resize (candidates.size ());
+        for (std::size_t c = 0; c < candidates.size (); ++c) { masks[c] = m_guessMasks[candidates[c]]; }
+        std::vector<std::uint32_t>& heuristic = scratch.m_scores;
+        heuristic.resize (candidates.size ());
+        scoreLetterMasks (masks.data (), masks.size (), weights, heuristic.data ());
+        std::vector<std::pair<double, std::uint32_t>>& ranked = scratch.m_ranked;
+        ranked.resize (candidates.size ());
+        for (std::size_t c = 0; c < candidates.size (); ++c) { ranked[c] = {double (heuristic[c]), candidates[c]}; }
+        auto better = [] (const std::pair<double, std::uint32_t>& a, const std::pair<double, std::uint32_t>& b) {
+            return a.first > b.first || (a.first == b.first && a.second < b.second);
+        };
+
+        std::vector<std::uint32_t>& options = scratch.m_options;
+        options.clear ();
+        std::pair<double, bool> bestScore;
+        std::size_t numSorted = 0;
+        for (std::size_t r = 0; r < ranked.size (); ++r) {
+            if (r != 0 && std::chrono::steady_clock::now () >= deadline) { break; }
+            if (r == numSorted) {
+                numSorted = std::min (ranked.size (), std::max (ANYTIME_FIRST_BATCH, 2 * numSorted));
+                std::nth_element (ranked.begin () + r, ranked.begin () + numSorted - 1, ranked.end (), better);
+                std::sort (ranked.begin () + r, ranked.begin () + numSorted, better);
+            }
+            std::uint32_t guess = ranked[r].second;
+            BucketCount buckets[NUM_PATTERNS<WORD_LENGTH>] = {};
+            bool beaten = false;
+            for (std::size_t a = 0; a < live.size () && !beaten; a += EARLY_EXIT_INTERVAL) {
+                std::size_t end = std::min (live.size (), a + EARLY_EXIT_INTERVAL);
+                patterns.forEach (guess, live.data () + a, end - a, [&buckets] (Pattern<WORD_LENGTH> pattern) { ++buckets[pattern]; });
+                PROFILE_COUNT (COUNT_PATTERN_LOOKUPS, end - a);
+                beaten = !options.empty () && end < live.size () && strategy.upperBound (buckets, live.size ()) < bestScore.first;
+            }
+            ++numEvaluated;
+            if (beaten) { continue; }
+            std::pair<double, bool> score (strategy.score (buckets, live.size ()), isPossible (inPlay, guess));
+            if (options.empty () || score > bestScore) {
+                options.clear ();
+                bestScore = score;
+            }
+            if (score == bestScore) { options.push_back (guess); }
+        }
+        PROFILE_COUNT (COUNT_GUESSES_SCORED, numEvaluated);
+        return m_guesses[options[std::uniform_int_distribution<std::size_t> (0, options.size () - 1) (rng)]];
+    }
+
+    /// \brief Scores one guess against every possible answer, the way bestWord () does.
+    /// \param[in] inPlay The words that are still in play in this game.
+    /// \param[in] strategy The way of scoring the guess.
+    /// \param[in] patterns The feedback for every allowed guess against every answer.
+    /// \param[in] guess A word from the list of allowed guesses.
+    /// \return The score.
+    double scoreGuess (const LiveWords& inPlay, const ScoringStrategy<WORD_LENGTH>& strategy, const PatternMatrix<WORD_LENGTH>& patterns,
+                       const Word<WORD_LENGTH>& guess) const {
+        std::size_t index = std::lower_bound (m_guesses.begin (), m_guesses.end (), guess) - m_guesses.begin ();
+        assert (index < m_guesses.size () && m_guesses[index] == guess);
+        BucketCount buckets[NUM_PATTERNS<WORD_LENGTH>] = {};
+        std::vector<std::uint32_t>& live = Scratch::forThisThread ().m_live;
+        inPlay.m_possibleWords.indices (live);
+        patterns.forEach (index, live.data (), live.size (), [&buckets] (Pattern<WORD_LENGTH> pattern) { ++buckets[pattern]; });
+        return strategy.score (buckets, live.size ());
+    }
+
+    /// \brief Updates the letter counts after some words have been ruled out.
+    /// \param[in,out] inPlay The words that are still in play, whose letter counts are updated.
+    /// \param[in] removed The words that were in inPlay.m_possibleWords and have just been taken out of it.
+    /// Taking away each removed word's letters costs a little for each one, while counting what is left from the
+    ///   letter index costs the same no matter how many words are left, so this does whichever is cheaper.
+    /// On the first guess of a game that is usually counting again, and after that it is usually taking away.
+    void forgetWords (LiveWords& inPlay, const Bitset& removed) const {
+        std::size_t count = removed.count ();
+        if (count == 0) { return; }
+        if (count > ALPHABET_SIZE * ((m_answers.size () + 63) / 64)) {
+            m_letterIndex.countLetters (inPlay.m_possibleWords, inPlay.m_letterCounts);
+            return;
+        }
+        removed.forEach ([this, &inPlay] (std::size_t w) {
+            for (unsigned short index = 0; index < WORD_LENGTH; ++index) { --inPlay.m_letterCounts[m_answers[w].code (index)]; }
+        });
+    }
+
+    /// \brief Gets the guesses that bestWord () and shortlistWord () consider, which in hard mode are only the legal ones.
+    /// \param[in] inPlay The words that are still in play in this game.
+    const std::vector<std::uint32_t>& guessCandidates (const LiveWords& inPlay) const {
+        if (!m_hardMode) { return m_allGuesses; }
+        std::vector<std::uint32_t>& legal = Scratch::forThisThread ().m_legal;
+        inPlay.m_legalGuesses.indices (legal);
+        assert (!legal.empty ());
+        return legal;
+    }
+
+    /// \brief Tests whether or not an allowed guess might be the answer.
+    /// \param[in] inPlay The words that are still in play in this game.
+    /// \param[in] guess The index of the guess.
+    /// \return True if the guess is one of the possible answers; false otherwise.
+    bool isPossible (const LiveWords& inPlay, std::uint32_t guess) const
+    {
+        return isIn (guess, inPlay.m_possibleWords);
+    }
+
+    /// \brief Tests whether or not an allowed guess is in a set of answers.
+    /// \param[in] guess The index of the guess.
+    /// \param[in] answers A set of indices into m_answers.
+    bool isIn (std::uint32_t guess, const Bitset& answers) const
+    {
+        return m_guessToAnswer[guess] != NOT_AN_ANSWER && answers.test (m_guessToAnswer[guess]);
+    }
+
+    /// \brief Gets the numbers 0 through m_guesses.size () - 1, for handing every guess to chooseBest ().
+    const std::vector<std::uint32_t>& allGuesses () const { return m_allGuesses; }
+
+    /// \brief Gets the words in play at the start of a game, when every answer is possible and every guess is legal.
+    /// A game starts with a copy of this, and goes back to the start by copying it again.
+    const LiveWords& start () const { return m_start; }
+
+    /// \brief Computes a fingerprint of both word lists, for recognizing files that were built from them.
+    std::uint64_t hash () const { return hashWords (m_answers) * 31 + hashWords (m_guesses); }
+
+    /// \brief Every word that might have been the answer at the start of the game.
+    /// These are sorted, and their positions are the columns of a PatternMatrix.
+    std::vector<Word<WORD_LENGTH>> m_answers;
+
+    /// \brief Every word that is allowed as a guess, which includes every answer.
+    /// These are sorted, and their positions are the rows of a PatternMatrix.
+    std::vector<Word<WORD_LENGTH>> m_guesses;
+
+    /// \brief Which answers have each letter in each position, and so on.
+    LetterIndex<WORD_LENGTH> m_letterIndex;
+
+    /// \brief The same for the allowed guesses, so that hard mode can rule guesses out a whole set at a time.
+    LetterIndex<WORD_LENGTH> m_guessIndex;
+
+    /// \brief True if every guess has to use the hints from the earlier ones (green letters where they were,
+    ///   and yellow letters somewhere).
+    bool m_hardMode = false;
+
+private:
+
+    /// \brief For each answer, which letters appear in it.
+    std::vector<std::uint32_t> m_letterMasks;
+
+    /// \brief The same for each allowed guess, for putting them in order in anytimeWord ().
+    std::vector<std::uint32_t> m_guessMasks;
+
+    /// \brief Marks an allowed guess that is not in the list of answers.
+    static constexpr std::uint32_t NOT_AN_ANSWER = UINT32_MAX;
+    /// \brief The fewest answers the first stage of shortlistWord () should look at.
+    static constexpr std::size_t MIN_SAMPLE_SIZE = 32;
+    /// \brief How many answers shortlistWord () puts in buckets between checks on whether a guess is already beaten.
+    static constexpr std::size_t EARLY_EXIT_INTERVAL = 256;
+    /// \brief How many guesses anytimeWord () sorts before it scores any.
+    static constexpr std::size_t ANYTIME_FIRST_BATCH = 64;
+
+    /// \brief Sorts the lists, removes any duplicates, and builds everything else from them.
+    /// \param[in] extraGuesses Words that are allowed as guesses but will never be the answer.
+    void finishLoading (const std::vector<Word<WORD_LENGTH>>& extraGuesses) {
+        std::sort (m_answers.begin (), m_answers.end ());
+        m_answers.erase (std::unique (m_answers.begin (), m_answers.end ()), m_answers.end ());
+        m_guesses = m_answers;
+        m_guesses.insert (m_guesses.end (), extraGuesses.begin (), extraGuesses.end ());
+        std::sort (m_guesses.begin (), m_guesses.end ());
+        m_guesses.erase (std::unique (m_guesses.begin (), m_guesses.end ()), m_guesses.end ());
+        m_allGuesses.resize (m_guesses.size ());
+        m_guessToAnswer.assign (m_guesses.size (), NOT_AN_ANSWER);
+        std::size_t answer = 0;
+        for (std::uint32_t guess = 0; guess < m_guesses.size (); ++guess) {
+            m_allGuesses[guess] = guess;
+            if (answer < m_answers.size () && m_answers[answer] == m_guesses[guess]) { m_guessToAnswer[guess] = answer++; }
+        }
+        m_letterIndex = LetterIndex<WORD_LENGTH> (m_answers);
+        m_guessIndex = LetterIndex<WORD_LENGTH> (m_guesses);
+        m_letterMasks.resize (m_answers.size ());
+        for (std::size_t w = 0; w < m_answers.size (); ++w) { m_letterMasks[w] = m_answers[w].letterMask (); }
+        m_guessMasks.resize (m_guesses.size ());
+        for (std::size_t g = 0; g < m_guesses.size (); ++g) { m_guessMasks[g] = m_guesses[g].letterMask (); }
+        m_start.m_possibleWords = Bitset (m_answers.size (), true);
+        m_letterIndex.countLetters (m_start.m_possibleWords, m_start.m_letterCounts);
+        m_start.m_legalGuesses = Bitset (m_guesses.size (), true);
+    }
+
+    /// \brief The words in play at the start of a game.
+    LiveWords m_start;
+
+    /// \brief The numbers 0 through m_guesses.size () - 1, for handing every guess to chooseBest ().
+    std::vector<std::uint32_t> m_allGuesses;
+
+    /// \brief For each allowed guess, its index in m_answers, or NOT_AN_ANSWER.
+    std::vector<std::uint32_t> m_guessToAnswer;
+};
+
+/// \brief Everything the feedback so far has told us about the answer, boiled down to one small value.
+/// For each position there is a mask of the letters that could still be there,
+///   and for each letter there are the fewest and the most copies of it that the answer could have.
+/// A word is consistent with all of the feedback exactly when it fits these, so checking one word takes a few
+///   integer operations, and two states can be compared or hashed without looking at any words.
+/// There is nothing in it but the arrays, so copying it (to look ahead in a search, say) is cheap.
+template <std::size_t WORD_LENGTH>
+class Knowledge {
+public:
+
+    /// \brief Creates the state for the start of a game, when anything goes.
+    Knowledge () { clear (); }
+
+    /// \brief Forgets everything, so that the state can be used for another game.
+    void
+    clear () {
+        std::fill (m_allowed, m_allowed + WORD_LENGTH, ALL_LETTERS);
+        std::fill (m_minCount, m_minCount + ALPHABET_SIZE, 0);
+        std::fill (m_maxCount, m_maxCount + ALPHABET_SIZE, WORD_LENGTH);
+    }
+
+    /// \brief Folds in the feedback to a guess.
+    /// \param[in] guess The word that was guessed.
+    /// \param[in] feedback The response that was received about the guess.
+    /// If feedback says that a letter is in the right position, that position can only be that letter.
+    /// Otherwise (whether it is in the wrong position or not there), that position can not be that letter.
+    /// If feedback says there are X green/yellow copies of a letter, the word must contain at least X copies.
+    /// If feedback says there are X green/yellow copies of a letter and not another, the word must contain at most X copies.
+    void
+    addFeedback (const Word<WORD_LENGTH>& guess, const std::string& feedback) {
+        assert (feedback.length () == WORD_LENGTH);
+        unsigned char marked[ALPHABET_SIZE] = {};
+        std::uint32_t notThere = 0;
+        for (unsigned short index = 0; index < WORD_LENGTH; ++index) {
+            assert (feedback[index] == NOT_THERE || feedback[index] == WRONG_SPOT || feedback[index] == RIGHT_SPOT);
+            unsigned short letter = guess.code (index);
+            if (feedback[index] == RIGHT_SPOT) { m_allowed[index] = 1u << letter; }
+            else { m_allowed[index] &= ~(1u << letter); }
+            if (feedback[index] == NOT_THERE) { notThere |= 1u << letter; }
+            else { ++marked[letter]; }
+        }
+        for (unsigned short index = 0; index < WORD_LENGTH; ++index) {
+            unsigned short letter = guess.code (index);
+            m_minCount[letter] = std::max (m_minCount[letter], marked[letter]);
+            if (notThere & (1u << letter)) { m_maxCount[letter] = std::min (m_maxCount[letter], marked[letter]); }
+        }
+    }
+
+    /// \brief Folds in only the hints that hard mode makes every later guess use.
+    /// \param[in] guess The word that was guessed.
+    /// \param[in] feedback The response that was received about the guess.
+    /// A letter in the right position has to stay there, and a letter that was marked X times has to appear
+    ///   at least X times, but nothing is ruled out by a letter being in the wrong position or not there.
+    void
+    addHints (const Word<WORD_LENGTH>& guess, const std::string& feedback) {
+        assert (feedback.length () == WORD_LENGTH);
+        unsigned char marked[ALPHABET_SIZE] = {};
+        for (unsigned short index = 0; index < WORD_LENGTH; ++index) {
+            unsigned short letter = guess.code (index);
+            if (feedback[index] == RIGHT_SPOT) { m_allowed[index] = 1u << letter; }
+            if (feedback[index] != NOT_THERE) { ++marked[letter]; }
+        }
+        for (unsigned short letter = 0; letter < ALPHABET_SIZE; ++letter) { m_minCount[letter] = std::max (m_minCount[letter], marked[letter]); }
+    }
+
+    /// \brief Tests whether or not a word is consistent with everything we know.
+    /// \param[in] word The word to test.
+    /// \return True if the word might be the answer; false otherwise.
+    bool
+    satisfies (const Word<WORD_LENGTH>& word) const {
+        unsigned char counts[ALPHABET_SIZE] = {};
+        for (unsigned short index = 0; index < WORD_LENGTH; ++index) {
+            unsigned short letter = word.code (index);
+            if ((m_allowed[index] & (1u << letter)) == 0) { return false; }
+            ++counts[letter];
+        }
+        for (unsigned short letter = 0; letter < ALPHABET_SIZE; ++letter) {
+            if (counts[letter] < m_minCount[letter] || counts[letter] > m_maxCount[letter]) { return false; }
+        }
+        return true;
+    }
+
+    /// \brief Removes every word that something we have learned since an earlier state rules out.
+    /// \param[in] before An earlier state of the same game, which every word in the set already fits.
+    /// \param[in] index The index of the dictionary that the set refers to.
+    /// \param[in,out] candidates The set of dictionary indices to filter.
+    /// Only what has changed is applied, and each change is a single pass of AND or AND-NOT over the set,
+    ///   rather than a test of each word.
+    void
+    narrow (const Knowledge& before, const LetterIndex<WORD_LENGTH>& index, Bitset& candidates) const {
+        for (unsigned short position = 0; position < WORD_LENGTH; ++position) {
+            std::uint32_t allowed = m_allowed[position];
+            std::uint32_t removed = before.m_allowed[position] & ~allowed;
+            if (removed == 0) { continue; }
+            if ((allowed & (allowed - 1)) == 0) {
+                candidates &= index.atPosition (position, 'A' + __builtin_ctz (allowed));
+                continue;
+            }
+            for (; removed != 0; removed &= removed - 1) {
+                candidates.andNot (index.atPosition (position, 'A' + __builtin_ctz (removed)));
+            }
+        }
+        for (unsigned short letter = 0; letter < ALPHABET_SIZE; ++letter) {
+            if (m_minCount[letter] > before.m_minCount[letter]) {
+                candidates &= index.atLeast ('A' + letter, m_minCount[letter]);
+            }
+            if (m_maxCount[letter] < before.m_maxCount[letter]) {
+                candidates.andNot (index.atLeast ('A' + letter, m_maxCount[letter] + 1));
+            }
+        }
+    }
+
+    bool operator== (const Knowledge& other) const {
+        return std::equal (m_allowed, m_allowed + WORD_LENGTH, other.m_allowed)
+            && std::equal (m_minCount, m_minCount + ALPHABET_SIZE, other.m_minCount)
+            && std::equal (m_maxCount, m_maxCount + ALPHABET_SIZE, other.m_maxCount);
+    }
+
+    bool operator!= (const Knowledge& other) const { return !(*this == other); }
+
+    /// \brief Computes a 64-bit fingerprint of the state.
+    std::uint64_t hash () const {
+        std::uint64_t result = 14695981039346656037ull;
+        auto mix = [&result] (std::uint64_t value) {
+            result = (result ^ value) * 1099511628211ull;
+        };
+        for (unsigned short index = 0; index < WORD_LENGTH; ++index) { mix (m_allowed[index]); }
+        for (unsigned short letter = 0; letter < ALPHABET_SIZE; ++letter) { mix (m_minCount[letter] | m_maxCount[letter] << 4); }
+        return result;
+    }
+
+private:
+    /// \brief A mask with a bit for every letter.
+    static constexpr std::uint32_t ALL_LETTERS = (1u << ALPHABET_SIZE) - 1;
+
+    /// \brief For each position, the letters that could be there (bit i for 'A' + i).
+    std::uint32_t m_allowed[WORD_LENGTH];
+    /// \brief For each letter, the fewest copies the answer could have.
+    unsigned char m_minCount[ALPHABET_SIZE];
+    /// \brief For each letter, the most copies the answer could have.
+    unsigned char m_maxCount[ALPHABET_SIZE];
+};
+
+template <std::size_t WORD_LENGTH>
+struct std::hash<Knowledge<WORD_LENGTH>>
+{
+  std::size_t operator()(const Knowledge<WORD_LENGTH>& k) const
+  {
+    return k.hash ();
+  }
+};
+
+
+/// \brief Updates what we know after getting feedback on a guess.
+/// \param[in,out] knowledge What we have learned so far.
+/// \param[in] words The word lists.
+/// \param[in,out] inPlay The words that are still in play in this game.
+/// \param[in] guess The word that was guessed.
+/// \param[in] feedback The response that was received about the guess.
+template <std::size_t WORD_LENGTH>
+void
+applyFeedback (Knowledge<WORD_LENGTH>& knowledge, const WordCollection<WORD_LENGTH>& words, LiveWords& inPlay, const Word<WORD_LENGTH>& guess,
+               const std::string& feedback) {
+    PROFILE_SCOPE (PHASE_APPLY_FEEDBACK);
+    Knowledge<WORD_LENGTH> before = knowledge;
+    Bitset& removed = Scratch::forThisThread ().m_removed;
+    removed = inPlay.m_possibleWords;
+    knowledge.addFeedback (guess, feedback);
+    knowledge.narrow (before, words.m_letterIndex, inPlay.m_possibleWords);
+    removed.andNot (inPlay.m_possibleWords);
+    words.forgetWords (inPlay, removed);
+    PROFILE_COUNT (COUNT_FEEDBACK, 1);
+    PROFILE_COUNT (COUNT_WORDS_ELIMINATED, removed.count ());
+    if (words.m_hardMode) {
+        // Each feedback's hints are applied on their own, since the legal guesses already fit the earlier ones.
+        Knowledge<WORD_LENGTH> hints;
+        hints.addHints (guess, feedback);
+        hints.narrow (Knowledge<WORD_LENGTH> (), words.m_guessIndex, inPlay.m_legalGuesses);
+    }
+}
+
+
+/// \brief The first few moves of every game, worked out ahead of time.
+/// When guesses are chosen deterministically, the opening guess and the replies to each feedback pattern
+///   only depend on the dictionary and the strategy, so there is no sense recomputing them every game.
+/// Moves are looked up by the feedback received so far, which (given that we always follow the book)
+///   determines everything that was guessed.
+template <std::size_t WORD_LENGTH>
+class OpeningBook {
+public:
+
+    /// \brief Creates an empty book.
+    /// \param[in] dictionaryHash The hash of the dictionary the book is for.
+    /// \param[in] strategyName The name of the strategy the book is for.
+    OpeningBook (std::uint64_t dictionaryHash, const std::string& strategyName)
+    : m_dictionaryHash (dictionaryHash), m_strategyName (strategyName) {}
+
+    /// \brief Records a move.
+    /// \param[in] history The feedback received so far (in order), which is empty for the first guess.
+    /// \param[in] guess The guess that should be made.
+    void add (const std::vector<Pattern<WORD_LENGTH>>& history, const Word<WORD_LENGTH>& guess) { m_moves[key (history)] = guess; }
+
+    /// \brief Looks up a move.
+    /// \param[in] history The feedback received so far (in order).
+    /// \return The guess that should be made, or nullptr if the book does not go that far.
+    const Word<WORD_LENGTH>* lookup (const std::vector<Pattern<WORD_LENGTH>>& history) const {
+        if (history.size () >= MAX_DEPTH) { return nullptr; }
+        auto iter = m_moves.find (key (history));
+        return iter == m_moves.end () ? nullptr : &iter->second;
+    }
+
+    /// \brief Gets the number of moves in the book.
+    std::size_t size () const { return m_moves.size (); }
+
+    /// \brief Writes the book to a text file.
+    /// \param[in] fileName The name of the file.
+    /// \return True if it worked; false otherwise.
+    /// After a header, each line holds the comma-separated feedback so far ("-" if none) and the guess to make.
+    bool save (const std::string& fileName) const {
+        std::ofstream out (fileName);
+        out << MAGIC << "\n" << m_dictionaryHash << " " << m_strategyName << "\n";
+        writeMoves (out);
+        return bool (out);
+    }
+
+    /// \brief Writes every move, one per line, the way save () does but without the header.
+    /// \param[in,out] out The stream to write to.
+    void writeMoves (std::ostream& out) const {
+        std::vector<std::pair<std::uint64_t, Word<WORD_LENGTH>>> moves (m_moves.begin (), m_moves.end ());
+        std::sort (moves.begin (), moves.end (), [] (const std::pair<std::uint64_t, Word<WORD_LENGTH>>& a, const std::pair<std::uint64_t, Word<WORD_LENGTH>>& b) {
+            return a.first < b.first;
+        });
+        for (const std::pair<std::uint64_t, Word<WORD_LENGTH>>& move : moves) {
+            std::vector<Pattern<WORD_LENGTH>> history = unkey (move.first);
+            if (history.empty ()) { out << "-"; }
+            for (std::size_t ply = 0; ply < history.size (); ++ply) {
+                out << (ply == 0 ? "" : ",") << patternToString<WORD_LENGTH> (history[ply]);
+            }
+            out << " " << move.second << "\n";
+        }
+    }
+
+    /// \brief Reads moves written by writeMoves (), until the end of the stream.
+    /// \param[in,out] in The stream to read from.
+    /// \param[in] prefix Feedback to put in front of each move's history, for a subtree that starts partway through the game.
+    /// \param[in] guesses The allowed guesses, sorted, which every move has to be one of, or nullptr to take any word.
+    /// \return False if a move was malformed, too deep or not an allowed guess; true otherwise.
+    /// The moves might come from a file someone edited or from another machine, so every one is checked before any
+    ///   are added, and if one is bad the book is left as it was.
+    bool readMoves (std::istream& in, const std::vector<Pattern<WORD_LENGTH>>& prefix = {}, const std::vector<Word<WORD_LENGTH>>* guesses = nullptr) {
+        std::vector<std::pair<std::vector<Pattern<WORD_LENGTH>>, Word<WORD_LENGTH>>> moves;
+        for (std::string line; std::getline (in, line); ) {
+            std::istringstream fields (line);
+            std::string path, guess, extra;
+            if (!(fields >> path)) { continue; }
+            if (!(fields >> guess) || fields >> extra || !isWordString<WORD_LENGTH> (guess)) { return false; }
+            std::vector<Pattern<WORD_LENGTH>> history = prefix;
+            if (path != "-") {
+                // Each pattern but the last is followed by a comma.
+                if ((path.length () + 1) % (WORD_LENGTH + 1) != 0) { return false; }
+                for (std::size_t start = 0; start < path.length () && history.size () < MAX_DEPTH; start += WORD_LENGTH + 1) {
+                    std::string chunk = path.substr (start, WORD_LENGTH);
+                    bool last = start + WORD_LENGTH == path.length ();
+                    if (!isFeedbackString<WORD_LENGTH> (chunk) || (!last && path[start + WORD_LENGTH] != ',')) { return false; }
+                    history.push_back (patternFromString<WORD_LENGTH> (chunk));
+                }
+            }
+            if (history.size () >= MAX_DEPTH) { return false; }
+            Word<WORD_LENGTH> word (guess);
+            if (guesses && !std::binary_search (guesses->begin (), guesses->end (), word)) { return false; }
+            moves.emplace_back (std::move (history), word);
+        }
+        for (const std::pair<std::vector<Pattern<WORD_LENGTH>>, Word<WORD_LENGTH>>& move : moves) { add (move.first, move.second); }
+        return true;
+    }
+
+    /// \brief Reads a book from a text file.
+    /// \param[in] fileName The name of the file.
+    /// \param[in] dictionaryHash The hash of the dictionary the book should be for.
+    /// \param[in] strategyName The name of the strategy the book should be for.
+    /// \param[in] guesses The allowed guesses, sorted, which every move has to be one of, or nullptr to take any word.
+    /// \return The book, or nullptr if the file does not exist, cannot be read, or is for something else.
+    static std::unique_ptr<OpeningBook<WORD_LENGTH>>
+    load (const std::string& fileName, std::uint64_t dictionaryHash, const std::string& strategyName,
+          const std::vector<Word<WORD_LENGTH>>* guesses = nullptr) {
+        std::ifstream in (fileName);
+        std::string magic, name;
+        std::uint64_t hash = 0;
+        if (!std::getline (in, magic) || magic != MAGIC || !(in >> hash >> name) || hash != dictionaryHash || name != strategyName) {
+            return nullptr;
+        }
+        std::unique_ptr<OpeningBook<WORD_LENGTH>> book (new OpeningBook<WORD_LENGTH> (dictionaryHash, strategyName));
+        if (!book->readMoves (in, {}, guesses)) { return nullptr; }
+        return book;
+    }
+
+    /// \brief The number of bits each pattern takes up in a key, which is as few as there can be rather than the size of a
+    ///   Pattern, so that 6- and 7-letter books can go as deep as the others.
+    static constexpr unsigned int BITS_PER_PATTERN = bitsToCount (NUM_PATTERNS<WORD_LENGTH>);
+    /// \brief The most guesses a book can hold for one game, which is limited by how many patterns fit in a key.
+    static constexpr std::size_t MAX_DEPTH = std::min<std::size_t> (7, 63 / BITS_PER_PATTERN + 1);
+
+private:
+
+    /// \brief Identifies a book file, and which version of the format it has.
+    static constexpr const char* MAGIC = "CHWordleBot opening book 1";
+
+    /// \brief Packs a history into an integer: a leading 1, then BITS_PER_PATTERN bits per pattern.
+    static std::uint64_t key (const std::vector<Pattern<WORD_LENGTH>>& history) {
+        assert (history.size () < MAX_DEPTH);
+        std::uint64_t result = 1;
+        for (Pattern<WORD_LENGTH> pattern : history) { result = (result << BITS_PER_PATTERN) | pattern; }
+        return result;
+    }
+
+    /// \brief Unpacks a history that was packed by key ().
+    static std::vector<Pattern<WORD_LENGTH>> unkey (std::uint64_t packed) {
+        std::vector<Pattern<WORD_LENGTH>> history;
+        while (packed > 1) {
+            history.insert (history.begin (), Pattern<WORD_LENGTH> (packed & ((std::uint64_t (1) << BITS_PER_PATTERN) - 1)));
+            packed >>= BITS_PER_PATTERN;
+        }
+        return history;
+    }
+
+    std::uint64_t m_dictionaryHash;
+    std::string m_strategyName;
+    std::unordered_map<std::uint64_t, Word<WORD_LENGTH>> m_moves;
+};
+
+
+/// \brief A bounded cache of what was worked out for each set of possible answers, which several threads can share.
+/// In a batch of games, lots of games end up with exactly the same words left by different routes,
+///   and there is no point choosing a guess for the same set twice.
+/// The same goes for searching for a decision tree, where the value is the best subtree's cost and first guess.
+/// Sets are identified only by their fingerprint; a collision between two different 64-bit fingerprints
+///   is unlikely enough that we ignore it.
+/// The table is set-associative: each fingerprint can only go in one small group of slots,
+///   and each group evicts with the CLOCK algorithm (an entry that has been used since the hand
+///   last passed it gets a second chance).
+/// All of the slots are allocated up front, so looking things up and inserting them never allocates.
+template <typename Value>
+class MemoTable {
+public:
+
+    /// \brief Creates an empty table.
+    /// \param[in] capacity The most entries the table may hold (rounded up to a multiple of the group size).
+    explicit MemoTable (std::size_t capacity)
+    : m_numGroups (std::max<std::size_t> (1, (capacity + WAYS - 1) / WAYS)), m_slots (m_numGroups * WAYS),
+      m_hands (m_numGroups, 0), m_locks (NUM_LOCKS), m_hits (0), m_misses (0), m_evictions (0) {}
+
+    /// \brief Looks up what was recorded for a set of possible answers.
+    /// \param[in] fingerprint The fingerprint of the set.
+    /// \param[out] value The value, if there is one.
+    /// \return True if there was a value; false otherwise.
+    bool lookup (std::uint64_t fingerprint, Value& value) {
+        std::size_t group = fingerprint % m_numGroups;
+        std::lock_guard<std::mutex> lock (m_locks[group % NUM_LOCKS]);
+        Slot* slots = &m_slots[group * WAYS];
+        for (std::size_t way = 0; way < WAYS; ++way) {
+            if (slots[way].m_used && slots[way].m_fingerprint == fingerprint) {
+                slots[way].m_referenced = true;
+                value = slots[way].m_value;
+                ++m_hits;
+                return true;
+            }
+        }
+        ++m_misses;
+        return false;
+    }
+
+    /// \brief Records a value for a set of possible answers, evicting an old entry if its group is full.
+    /// \param[in] fingerprint The fingerprint of the set.
+    /// \param[in] value The value.
+    void insert (std::uint64_t fingerprint, const Value& value) {
+        std::size_t group = fingerprint % m_numGroups;
+        std::lock_guard<std::mutex> lock (m_locks[group % NUM_LOCKS]);
+        Slot* slots = &m_slots[group * WAYS];
+        for (std::size_t way = 0; way < WAYS; ++way) {
+            if (slots[way].m_used && slots[way].m_fingerprint == fingerprint) { return; }
+        }
+        for (std::size_t way = 0; way < WAYS; ++way) {
+            if (!slots[way].m_used) {
+                slots[way] = {fingerprint, value, true, false};
+                return;
+            }
+        }
+        unsigned char& hand = m_hands[group];
+        while (slots[hand].m_referenced) {
+            slots[hand].m_referenced = false;
+            hand = (hand + 1) % WAYS;
+        }
+        slots[hand] = {fingerprint, value, true, false};
+        hand = (hand + 1) % WAYS;
+        ++m_evictions;
+    }
+
+    std::size_t hits () const { return m_hits; }
+    std::size_t misses () const { return m_misses; }
+    std::size_t evictions () const { return m_evictions; }
+
+private:
+
+    /// \brief The number of slots a fingerprint might be stored in.
+    static constexpr std::size_t WAYS = 8;
+    /// \brief The number of locks, each of which covers every NUM_LOCKS-th group.
+    static constexpr std::size_t NUM_LOCKS = 64;
+
+    struct Slot {
+        std::uint64_t m_fingerprint;
+        Value m_value;
+        bool m_used;
+        bool m_referenced;
+    };
+
+    std::size_t m_numGroups;
+    std::vector<Slot> m_slots;
+    /// \brief The CLOCK hand for each group.
+    std::vector<unsigned char> m_hands;
+    std::vector<std::mutex> m_locks;
+    std::atomic<std::size_t> m_hits;
+    std::atomic<std::size_t> m_misses;
+    std::atomic<std::size_t> m_evictions;
+};
+
+
+/// \brief How choosing guesses from a shortlist compares with scoring every guess, added up over many choices.
+struct ShortlistStats {
+
+    ShortlistStats () : m_choices (0), m_misses (0), m_shortlistNanoseconds (0), m_exactNanoseconds (0) {}
+
+    /// \brief Records one choice.
+    /// \param[in] shortlistNanoseconds How long choosing with the shortlist took.
+    /// \param[in] exactNanoseconds How long choosing by scoring every guess took.
+    /// \param[in] missed True if the shortlist's guess scored worse than the best guess.
+    void record (std::uint64_t shortlistNanoseconds, std::uint64_t exactNanoseconds, bool missed) {
+        ++m_choices;
+        if (missed) { ++m_misses; }
+        m_shortlistNanoseconds += shortlistNanoseconds;
+        m_exactNanoseconds += exactNanoseconds;
+    }
+
+    std::atomic<std::size_t> m_choices;
+    std::atomic<std::size_t> m_misses;
+    std::atomic<std::uint64_t> m_shortlistNanoseconds;
+    std::atomic<std::uint64_t> m_exactNanoseconds;
+};
+
+
+/// \brief How much choosing guesses before a deadline got done, and how it compares with scoring every guess,
+///   added up over many choices.
+struct AnytimeStats {
+
+    AnytimeStats () : m_choices (0), m_evaluated (0), m_candidates (0), m_cutOff (0), m_misses (0), m_nanoseconds (0) {}
+
+    /// \brief Records one choice.
+    /// \param[in] evaluated The number of guesses that were scored before the deadline.
+    /// \param[in] candidates The number of guesses there were to score.
+    /// \param[in] missed True if the guess scored worse than the best guess.
+    /// \param[in] nanoseconds How long choosing took.
+    void record (std::size_t evaluated, std::size_t candidates, bool missed, std::uint64_t nanoseconds) {
+        ++m_choices;
+        m_evaluated += evaluated;
+        m_candidates += candidates;
+        if (evaluated < candidates) { ++m_cutOff; }
+        if (missed) { ++m_misses; }
+        m_nanoseconds += nanoseconds;
+    }
+
+    std::atomic<std::size_t> m_choices;
+    std::atomic<std::uint64_t> m_evaluated;
+    std::atomic<std::uint64_t> m_candidates;
+    /// \brief The number of choices where the deadline came before every guess was scored.
+    std::atomic<std::size_t> m_cutOff;
+    std::atomic<std::size_t> m_misses;
+    std::atomic<std::uint64_t> m_nanoseconds;
+};
+
+
+/// \brief The fewest answers worth scoring guesses against on a device, since with fewer it is quicker to do it here than to send them.
+const std::size_t DEVICE_MIN_ANSWERS = 256;
+
+#ifdef CHWORDLEBOT_OPENCL
+/// \brief The OpenCL program that scores every guess against a list of answers.
+/// Each work-group takes one guess, and its work-items share out the answers, working out the feedback the same way
+///   computeFeedback () does and counting the patterns in local memory.  Then they add up the sums that the strategy's
+///   score is made from.  setUp () puts WORD_LENGTH, NUM_PATTERNS, GROUP_SIZE, and SCORE in front of it.
+const char* const DEVICE_PROGRAM = R"(
+__kernel void
+scoreGuesses (__global const uchar* guesses, __global const uchar* answers, __global const uint* live, uint total, __global float* scores) {
+    __local uint buckets[NUM_PATTERNS];
+    __local float logSums[GROUP_SIZE];
+    __local ulong squareSums[GROUP_SIZE];
+    __local uint largests[GROUP_SIZE];
+    const uint guess = get_group_id (0);
+    const uint item = get_local_id (0);
+    for (uint pattern = item; pattern < NUM_PATTERNS; pattern += GROUP_SIZE) { buckets[pattern] = 0; }
+    barrier (CLK_LOCAL_MEM_FENCE);
+
+    uchar guessCodes[WORD_LENGTH];
+    for (uint index = 0; index < WORD_LENGTH; ++index) { guessCodes[index] = guesses[guess * WORD_LENGTH + index]; }
+    for (uint a = item; a < total; a += GROUP_SIZE) {
+        __global const uchar* answer = answers + live[a] * WORD_LENGTH;
+        uchar unmatched[26];
+        for (uint letter = 0; letter < 26; ++letter) { unmatched[letter] = 0; }
+        uint green[WORD_LENGTH];
+        for (uint index = 0; index < WORD_LENGTH; ++index) {
+            green[index] = answer[index] == guessCodes[index];
+            unmatched[answer[index]] += 1 - green[index];
+        }
+        uint pattern = 0;
+        uint place = 1;
+        for (uint index = 0; index < WORD_LENGTH; ++index) {
+            uint yellow = (1 - green[index]) & (unmatched[guessCodes[index]] != 0);
+            unmatched[guessCodes[index]] -= yellow;
+            pattern += (2 * green[index] + yellow) * place;
+            place *= 3;
+        }
+        atomic_inc (&buckets[pattern]);
+    }
+    barrier (CLK_LOCAL_MEM_FENCE);
+
+    float logSum = 0.0f;
+    ulong squareSum = 0;
+    uint largest = 0;
+    for (uint pattern = item; pattern < NUM_PATTERNS; pattern += GROUP_SIZE) {
+        uint size = buckets[pattern];
+        if (size > 1) { logSum += size * log2 ((float) size); }
+        squareSum += (ulong) size * size;
+        largest = max (largest, size);
+    }
+    logSums[item] = logSum;
+    squareSums[item] = squareSum;
+    largests[item] = largest;
+    for (uint stride = GROUP_SIZE / 2; stride > 0; stride /= 2) {
+        barrier (CLK_LOCAL_MEM_FENCE);
+        if (item < stride) {
+            logSums[item] += logSums[item + stride];
+            squareSums[item] += squareSums[item + stride];
+            largests[item] = max (largests[item], largests[item + stride]);
+        }
+    }
+    if (item == 0) {
+        logSum = logSums[0];
+        squareSum = squareSums[0];
+        largest = largests[0];
+        scores[guess] = SCORE;
+    }
+}
+)";
+
+/// \brief Scores every allowed guess on a GPU (or whatever OpenCL device there is), to find the few worth scoring exactly.
+/// The words are sent to the device once; after that each call only sends the list of answers, and gets back a score for each guess.
+/// The device works in single precision, so rather than trusting its order this keeps every guess that came close to making the cut,
+///   and the CPU scores those properly.  With a small enough slack that is a few more than were asked for,
+///   and the guesses chosen from them are the ones the CPU would have chosen from all of them.
+template <std::size_t WORD_LENGTH>
+class DeviceScorer {
+public:
+
+    /// \brief Sets up a device to score guesses with a strategy.
+    /// \param[in] words The word lists.
+    /// \param[in] strategy The way of scoring guesses.
+    /// \param[in,out] log Where to say which device it is, or why there is none.
+    /// \return The scorer, or nullptr if there is no device that can be used, in which case the CPU does everything.
+    static std::unique_ptr<DeviceScorer<WORD_LENGTH>>
+    create (const WordCollection<WORD_LENGTH>& words, const ScoringStrategy<WORD_LENGTH>& strategy, std::ostream& log) {
+        if (!strategy.deviceScore ()) {
+            log << "The " << strategy.name () << " strategy can not be scored on a device, so guesses will be scored on the CPU.\n";
+            return nullptr;
+        }
+        std::unique_ptr<DeviceScorer<WORD_LENGTH>> scorer (new DeviceScorer<WORD_LENGTH> ());
+        std::string problem = scorer->setUp (words, strategy.deviceScore ());
+        if (!problem.empty ()) {
+            log << "Guesses will be scored on the CPU, since OpenCL " << problem << ".\n";
+            return nullptr;
+        }
+        log << "Scoring guesses on " << scorer->m_deviceName << "\n";
+        return scorer;
+    }
+
+    ~DeviceScorer () {
+        for (cl_mem buffer : {m_guesses, m_answers, m_live, m_scores}) {
+            if (buffer) { clReleaseMemObject (buffer); }
+        }
+        if (m_kernel) { clReleaseKernel (m_kernel); }
+        if (m_program) { clReleaseProgram (m_program); }
+        if (m_queue) { clReleaseCommandQueue (m_queue); }
+        if (m_context) { clReleaseContext (m_context); }
+    }
+
+    /// \brief Finds the guesses that might be among the best against some answers.
+    /// \param[in] answers The indices of the answers.
+    /// \param[in] count The number of answers.
+    /// \param[in] keep How many of the best guesses are wanted.
+    /// \param[out] shortlisted At least that many guesses, in increasing order, including every one that might be among the best.
+    /// \return True if it worked; false if the device failed, in which case the CPU should score every guess.
+    /// Calls from different threads take turns.
+    bool shortlist (const std::uint32_t* answers, std::size_t count, std::size_t keep, std::vector<std::uint32_t>& shortlisted) const {
+        assert (count > 0 && count <= m_numAnswers && keep > 0);
+        PROFILE_SCOPE (PHASE_SCORE_GUESSES);
+        std::lock_guard<std::mutex> lock (m_mutex);
+        cl_uint total = count;
+        std::size_t local = GROUP_SIZE;
+        std::size_t global = m_numGuesses * GROUP_SIZE;
+        if (clEnqueueWriteBuffer (m_queue, m_live, CL_FALSE, 0, count * sizeof (cl_uint), answers, 0, nullptr, nullptr) != CL_SUCCESS
+            || clSetKernelArg (m_kernel, 3, sizeof (total), &total) != CL_SUCCESS
+            || clEnqueueNDRangeKernel (m_queue, m_kernel, 1, nullptr, &global, &local, 0, nullptr, nullptr) != CL_SUCCESS
+            || clEnqueueReadBuffer (m_queue, m_scores, CL_TRUE, 0, m_numGuesses * sizeof (cl_float), m_hostScores.data (), 0, nullptr, nullptr)
+               != CL_SUCCESS) {
+            return false;
+        }
+        PROFILE_COUNT (COUNT_GUESSES_SCORED, m_numGuesses);
+        keep = std::min (keep, m_numGuesses);
+        m_sorted = m_hostScores;
+        std::nth_element (m_sorted.begin (), m_sorted.begin () + (keep - 1), m_sorted.end (), std::greater<float> ());
+        float cutoff = m_sorted[keep - 1] - SLACK * std::max (1.0f, std::fabs (m_sorted[keep - 1]));
+        shortlisted.clear ();
+        for (std::uint32_t guess = 0; guess < m_numGuesses; ++guess) {
+            if (m_hostScores[guess] >= cutoff) { shortlisted.push_back (guess); }
+        }
+        return true;
+    }
+
+private:
+
+    /// \brief The number of work-items that share the answers for each guess.
+    static constexpr std::size_t GROUP_SIZE = 64;
+    /// \brief How far, relative to the score that just makes the cut, a guess may fall short and still be kept.
+    /// Single precision is good to about one part in ten million, so this is plenty.
+    static constexpr float SLACK = 1e-4f;
+
+    DeviceScorer ()
+    : m_numGuesses (0), m_numAnswers (0), m_device (nullptr), m_context (nullptr), m_queue (nullptr), m_program (nullptr), m_kernel (nullptr),
+      m_guesses (nullptr), m_answers (nullptr), m_live (nullptr), m_scores (nullptr) {}
+
+    /// \brief Describes a failure.
+    static std::string failed (const std::string& what, cl_int status) { return "could not " + what + " (error " + std::to_string (status) + ")"; }
+
+    /// \brief Lays out words one letter code to a byte, for the device.
+    static std::vector<cl_uchar> unpack (const std::vector<Word<WORD_LENGTH>>& words) {
+        std::vector<cl_uchar> codes (words.size () * WORD_LENGTH);
+        for (std::size_t w = 0; w < words.size (); ++w) {
+            for (unsigned short index = 0; index < WORD_LENGTH; ++index) { codes[w * WORD_LENGTH + index] = words[w].code (index); }
+        }
+        return codes;
+    }
+
+    /// \brief Finds a device, builds the program for it, and sends it the words.
+    /// \param[in] words The word lists.
+    /// \param[in] score The strategy's score, as an OpenCL C expression.
+    /// \return What went wrong, or an empty string if nothing did.
+    std::string setUp (const WordCollection<WORD_LENGTH>& words, const char* score) {
+        m_numGuesses = words.m_guesses.size ();
+        m_numAnswers = words.m_answers.size ();
+        cl_uint numPlatforms = 0;
+        cl_int status = clGetPlatformIDs (0, nullptr, &numPlatforms);
+        if (status != CL_SUCCESS || numPlatforms == 0) { return "found no platforms"; }
+        std::vector<cl_platform_id> platforms (numPlatforms);
+        clGetPlatformIDs (numPlatforms, platforms.data (), nullptr);
+        // A GPU if there is one, and otherwise whatever there is.
+        for (cl_device_type type : {cl_device_type (CL_DEVICE_TYPE_GPU), cl_device_type (CL_DEVICE_TYPE_ALL)}) {
+            for (std::size_t p = 0; p < platforms.size () && !m_device; ++p) {
+                if (clGetDeviceIDs (platforms[p], type, 1, &m_device, nullptr) != CL_SUCCESS) { m_device = nullptr; }
+            }
+        }
+        if (!m_device) { return "found no devices"; }
+        char name[256] = {};
+        clGetDeviceInfo (m_device, CL_DEVICE_NAME, sizeof (name) - 1, name, nullptr);
+        m_deviceName = name;
+
+        m_context = clCreateContext (nullptr, 1, &m_device, nullptr, nullptr, &status);
+        if (status != CL_SUCCESS) { return failed ("create a context", status); }
+        m_queue = clCreateCommandQueue (m_context, m_device, 0, &status);
+        if (status != CL_SUCCESS) { return failed ("create a command queue", status); }
+        std::string source = "#define WORD_LENGTH " + std::to_string (WORD_LENGTH) + "\n#define NUM_PATTERNS " + std::to_string (NUM_PATTERNS<WORD_LENGTH>)
+                           + "\n#define GROUP_SIZE " + std::to_string (GROUP_SIZE) + "\n#define SCORE (" + score + ")\n" + DEVICE_PROGRAM;
+        const char* text = source.c_str ();
+        m_program = clCreateProgramWithSource (m_context, 1, &text, nullptr, &status);
+        if (status != CL_SUCCESS) { return failed ("load the program", status); }
+        status = clBuildProgram (m_program, 1, &m_device, nullptr, nullptr, nullptr);
+        if (status != CL_SUCCESS) {
+            std::size_t length = 0;
+            clGetProgramBuildInfo (m_program, m_device, CL_PROGRAM_BUILD_LOG, 0, nullptr, &length);
+            std::string buildLog (length, '\0');
+            clGetProgramBuildInfo (m_program, m_device, CL_PROGRAM_BUILD_LOG, length, &buildLog[0], nullptr);
+            return failed ("build the program", status) + ":\n" + buildLog;
+        }
+        m_kernel = clCreateKernel (m_program, "scoreGuesses", &status);
+        if (status != CL_SUCCESS) { return failed ("create the kernel", status); }
+
+        std::vector<cl_uchar> guesses = unpack (words.m_guesses);
+        std::vector<cl_uchar> answers = unpack (words.m_answers);
+        m_guesses = clCreateBuffer (m_context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, guesses.size (), guesses.data (), &status);
+        if (status != CL_SUCCESS) { return failed ("send the guesses", status); }
+        m_answers = clCreateBuffer (m_context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, answers.size (), answers.data (), &status);
+        if (status != CL_SUCCESS) { return failed ("send the answers", status); }
+        m_live = clCreateBuffer (m_context, CL_MEM_READ_ONLY, m_numAnswers * sizeof (cl_uint), nullptr, &status);
+        if (status != CL_SUCCESS) { return failed ("make room for the answers' indices", status); }
+        m_scores = clCreateBuffer (m_context, CL_MEM_WRITE_ONLY, m_numGuesses * sizeof (cl_float), nullptr, &status);
+        if (status != CL_SUCCESS) { return failed ("make room for the scores", status); }
+        if ((status = clSetKernelArg (m_kernel, 0, sizeof (cl_mem), &m_guesses)) != CL_SUCCESS
+            || (status = clSetKernelArg (m_kernel, 1, sizeof (cl_mem), &m_answers)) != CL_SUCCESS
+            || (status = clSetKernelArg (m_kernel, 2, sizeof (cl_mem), &m_live)) != CL_SUCCESS
+            || (status = clSetKernelArg (m_kernel, 4, sizeof (cl_mem), &m_scores)) != CL_SUCCESS) {
+            return failed ("set up the kernel", status);
+        }
+        m_hostScores.resize (m_numGuesses);
+        m_sorted.resize (m_numGuesses);
+        return "";
+    }
+
+    std::size_t m_numGuesses;
+    std::size_t m_numAnswers;
+    std::string m_deviceName;
+    cl_device_id m_device;
+    cl_context m_context;
+    cl_command_queue m_queue;
+    cl_program m_program;
+    cl_kernel m_kernel;
+    cl_mem m_guesses;
+    cl_mem m_answers;
+    cl_mem m_live;
+    cl_mem m_scores;
+    /// \brief The scores read back from the device, and a copy to find the cutoff in, which only one caller uses at a time.
+    mutable std::vector<float> m_hostScores;
+    mutable std::vector<float> m_sorted;
+    mutable std::mutex m_mutex;
+};
+#else
+/// \brief Stands in for the OpenCL scorer in builds without it: there is never a device, so the CPU does everything.
+template <std::size_t WORD_LENGTH>
+class DeviceScorer {
+public:
+
+    static std::unique_ptr<DeviceScorer<WORD_LENGTH>>
+    create (const WordCollection<WORD_LENGTH>&, const ScoringStrategy<WORD_LENGTH>&, std::ostream& log) {
+        log << "This build can not use a GPU, so guesses will be scored on the CPU; compile with -DCHWORDLEBOT_OPENCL and link with -lOpenCL to use one.\n";
+        return nullptr;
+    }
+
+    bool shortlist (const std::uint32_t*, std::size_t, std::size_t, std::vector<std::uint32_t>&) const { return false; }
+};
+#endif
+
+
+/// \brief The way guesses are chosen: which strategy, and what it needs to run.
+template <std::size_t WORD_LENGTH>
+struct Solver {
+
+    /// \brief Chooses the next guess.
+    /// \param[in] words The word lists.
+    /// \param[in] inPlay The words that are still in play in this game.
+    /// \param[in] history The feedback received so far in this game, in order.
+    /// \param[in,out] rng The random number generator used to break ties.
+    /// \return The word to guess.
+    /// If the opening book covers this point in the game, the guess comes from there.
+    /// Otherwise, if there is a memo table, the guess depends only on the set of possible answers (and in hard mode, legal guesses):
+    ///   ties are broken with a generator seeded from the set's fingerprint, so that whichever game
+    ///   gets to a set first, the same guess is remembered for it.
+    Word<WORD_LENGTH> chooseGuess (const WordCollection<WORD_LENGTH>& words, const LiveWords& inPlay, const std::vector<Pattern<WORD_LENGTH>>& history,
+                                   std::mt19937& rng) const {
+        PROFILE_SCOPE (PHASE_CHOOSE_GUESS);
+        if (m_book) {
+            const Word<WORD_LENGTH>* move = m_book->lookup (history);
+            if (move) {
+                PROFILE_COUNT (COUNT_BOOK_HITS, 1);
+                return *move;
+            }
+        }
+        if (m_memo) {
+            std::uint64_t fingerprint = inPlay.m_possibleWords.hash ();
+            if (words.m_hardMode) { fingerprint = fingerprint * 31 + inPlay.m_legalGuesses.hash (); }
+            Word<WORD_LENGTH> guess;
+            if (m_memo->lookup (fingerprint, guess)) {
+                PROFILE_COUNT (COUNT_MEMO_HITS, 1);
+                return guess;
+            }
+            std::mt19937 stateRng (fingerprint ^ (fingerprint >> 32));
+            guess = computeGuess (words, inPlay, stateRng);
+            m_memo->insert (fingerprint, guess);
+            return guess;
+        }
+        return computeGuess (words, inPlay, rng);
+    }
+
+    /// \brief Chooses the next guess by scoring the candidates, without looking anything up.
+    /// \param[in] words The word lists.
+    /// \param[in] inPlay The words that are still in play in this game.
+    /// \param[in,out] rng The random number generator used to break ties.
+    /// \return The word to guess.
+    /// If there is a shortlist and somewhere to keep statistics on it, the guess with the shortlist is compared
+    ///   with the one bestWord () would have made (using a copy of the generator, so the game goes the same either way).
+    /// With a device and no shortlist, the device picks out the guesses worth scoring while there are lots of answers left.
+    /// With a deadline, the shortlist and the device are not used; see anytimeGuess ().
+    Word<WORD_LENGTH> computeGuess (const WordCollection<WORD_LENGTH>& words, const LiveWords& inPlay, std::mt19937& rng) const {
+        if (!m_strategy) { return words.bestWord (inPlay, rng); }
+        if (m_deadline.count () != 0) { return anytimeGuess (words, inPlay, rng); }
+        if (m_device && m_shortlistSize == 0 && !words.m_hardMode && inPlay.m_possibleWords.count () >= DEVICE_MIN_ANSWERS) {
+            std::vector<std::uint32_t> live, shortlisted;
+            inPlay.m_possibleWords.indices (live);
+            if (m_device->shortlist (live.data (), live.size (), 1, shortlisted)) {
+                return words.bestWordAmong (inPlay, *m_strategy, *m_patterns, shortlisted, rng, m_numThreads);
+            }
+        }
+        if (m_shortlistSize == 0) { return words.bestWord (inPlay, *m_strategy, *m_patterns, rng, m_numThreads); }
+        if (!m_shortlistStats) { return words.shortlistWord (inPlay, *m_strategy, *m_patterns, rng, m_numThreads, m_shortlistSize, m_sampleStride); }
+        std::mt19937 exactRng = rng;
+        auto start = std::chrono::steady_clock::now ();
+        Word<WORD_LENGTH> guess = words.shortlistWord (inPlay, *m_strategy, *m_patterns, rng, m_numThreads, m_shortlistSize, m_sampleStride);
+        auto middle = std::chrono::steady_clock::now ();
+        Word<WORD_LENGTH> exact = words.bestWord (inPlay, *m_strategy, *m_patterns, exactRng, m_numThreads);
+        auto end = std::chrono::steady_clock::now ();
+        bool missed = words.scoreGuess (inPlay, *m_strategy, *m_patterns, guess) < words.scoreGuess (inPlay, *m_strategy, *m_patterns, exact);
+        m_shortlistStats->record (std::chrono::duration_cast<std::chrono::nanoseconds> (middle - start).count (),
+                                  std::chrono::duration_cast<std::chrono::nanoseconds> (end - middle).count (), missed);
+        return guess;
+    }
+
+    /// \brief Chooses the best guess it can before the deadline, which is counted from now.
+    /// \param[in] words The word lists.
+    /// \param[in] inPlay The words that are still in play in this game.
+    /// \param[in,out] rng The random number generator used to break ties.
+    /// \return The word to guess.
+    /// If there is somewhere to keep statistics, it also records how many guesses were scored in time, and whether
+    ///   the guess was as good as the one bestWord () would have made (using a copy of the generator, as with a shortlist).
+    Word<WORD_LENGTH> anytimeGuess (const WordCollection<WORD_LENGTH>& words, const LiveWords& inPlay, std::mt19937& rng) const {
+        auto start = std::chrono::steady_clock::now ();
+        std::size_t evaluated;
+        if (!m_anytimeStats) { return words.anytimeWord (inPlay, *m_strategy, *m_patterns, rng, start + m_deadline, evaluated); }
+        std::mt19937 exactRng = rng;
+        Word<WORD_LENGTH> guess = words.anytimeWord (inPlay, *m_strategy, *m_patterns, rng, start + m_deadline, evaluated);
+        std::uint64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now () - start).count ();
+        std::size_t candidates = inPlay.m_possibleWords.count () == 1 ? 0 : words.guessCandidates (inPlay).size ();
+        Word<WORD_LENGTH> exact = words.bestWord (inPlay, *m_strategy, *m_patterns, exactRng, m_numThreads);
+        bool missed = words.scoreGuess (inPlay, *m_strategy, *m_patterns, guess) < words.scoreGuess (inPlay, *m_strategy, *m_patterns, exact);
+        m_anytimeStats->record (evaluated, candidates, missed, nanoseconds);
+        return guess;
+    }
+
+    /// \brief Gets the name of the strategy.
+    std::string name () const {
+        if (!m_treeName.empty ()) { return m_treeName; }
+        return m_strategy ? m_strategy->name () : FREQUENCY_STRATEGY_NAME;
+    }
+
+    /// \brief The scoring strategy, or nullptr to use the letter-frequency heuristic.
+    const ScoringStrategy<WORD_LENGTH>* m_strategy;
+    /// \brief The feedback patterns, which are needed if there is a scoring strategy.
+    const PatternMatrix<WORD_LENGTH>* m_patterns;
+    /// \brief The number of threads to use when choosing each guess.
+    unsigned int m_numThreads;
+    /// \brief Precomputed guesses for the start of the game, or nullptr if there are none.
+    const OpeningBook<WORD_LENGTH>* m_book = nullptr;
+    /// \brief Guesses already chosen for sets of possible answers, or nullptr to always compute them.
+    MemoTable<Word<WORD_LENGTH>>* m_memo = nullptr;
+    /// \brief The number of guesses to score exactly, after ranking them all against a sample, or 0 to score them all.
+    std::size_t m_shortlistSize = 0;
+    /// \brief With a shortlist, the sample has one in this many of the possible answers.
+    std::size_t m_sampleStride = DEFAULT_SAMPLE_STRIDE;
+    /// \brief Where to keep track of how a shortlist compares to scoring every guess, or nullptr to not bother.
+    ShortlistStats* m_shortlistStats = nullptr;
+    /// \brief A GPU to do the first pass of scoring on, or nullptr to do it all on the CPU.
+    const DeviceScorer<WORD_LENGTH>* m_device = nullptr;
+    /// \brief How long choosing a guess may take, or 0 for as long as scoring every guess does.
+    std::chrono::nanoseconds m_deadline = std::chrono::nanoseconds (0);
+    /// \brief Where to keep track of how much gets done before the deadline, or nullptr to not bother.
+    AnytimeStats* m_anytimeStats = nullptr;
+    /// \brief The name of the kind of decision tree the book holds, or empty if it is just an opening book.
+    /// A tree covers the whole game, so the strategy only gets used if the feedback leaves it.
+    std::string m_treeName = "";
+};
+
+
+/// \brief Fills in an opening book by playing out every feedback pattern for the first few guesses.
+/// \param[in] solver The way guesses are chosen.  Its own book and memo table, if any, are ignored.
+/// \param[in] words The word lists.
+/// \param[in] inPlay The words that are still in play at this point.
+/// \param[in] knowledge What we have learned so far.
+/// \param[in,out] history The feedback received so far, which is restored before returning.
+/// \param[in] depth The number of guesses the book should cover.
+/// \param[in,out] rng The random number generator used to break ties.
+/// \param[in,out] book The book to add moves to.
+template <std::size_t WORD_LENGTH>
+void
+buildOpeningBook (const Solver<WORD_LENGTH>& solver, const WordCollection<WORD_LENGTH>& words, const LiveWords& inPlay,
+                  const Knowledge<WORD_LENGTH>& knowledge, std::vector<Pattern<WORD_LENGTH>>& history, std::size_t depth, std::mt19937& rng,
+                  OpeningBook<WORD_LENGTH>& book) {
+    Word<WORD_LENGTH> guess = solver.computeGuess (words, inPlay, rng);
+    book.add (history, guess);
+    if (history.size () + 1 >= depth) { return; }
+    bool seen[NUM_PATTERNS<WORD_LENGTH>] = {};
+    inPlay.m_possibleWords.forEach ([&] (std::size_t answer) {
+        seen[computeFeedback (guess, words.m_answers[answer])] = true;
+    });
+    for (std::size_t pattern = 0; pattern < NUM_PATTERNS<WORD_LENGTH>; ++pattern) {
+        if (!seen[pattern] || pattern == ALL_RIGHT<WORD_LENGTH>) { continue; }
+        LiveWords next = inPlay;
+        Knowledge<WORD_LENGTH> nextKnowledge = knowledge;
+        applyFeedback (nextKnowledge, words, next, guess, patternToString<WORD_LENGTH> (pattern));
+        if (next.m_possibleWords.none ()) { continue; }
+        history.push_back (pattern);
+        buildOpeningBook (solver, words, next, nextKnowledge, history, depth, rng, book);
+        history.pop_back ();
+    }
+}
+
+
+/// \brief The most guesses a real game allows; games that take longer count as failures.
+const int MAX_GUESSES = 6;
+/// \brief The most guesses we will make in a simulated game before giving up on it.
+const int MAX_SIMULATED_GUESSES = 32;
+
+/// \brief Searches for the decision tree that solves every possible answer in the fewest guesses altogether.
+/// A tree says what to guess first, then what to guess after each feedback that could come back, and so on.
+/// The cost of a set of answers with some number of guesses to go is the total number of guesses over all of them:
+///   a guess costs one for every answer, and then each bucket of answers it leaves (other than the one
+///   it wins outright) costs whatever that bucket costs with one guess fewer.
+/// Trying every allowed guess at every point is hopeless, so only the best few according to a scoring strategy
+///   are tried, but within that the search is exact.
+/// It is branch and bound: a bucket of m answers costs at least 2m - 1 (one guess might win one of them,
+///   but each of the others needs at least two), so a guess is dropped as soon as what its buckets have cost
+///   so far plus that bound for the rest can not beat the best guess found already, and each bucket is searched
+///   knowing how little it would have to cost to matter.
+/// Exact costs go in a memo table, keyed by the set and the number of guesses to go, since
+///   the same set turns up again and again after different guesses.
+/// At the top, every (guess, bucket) pair is a separate piece of work, and each thread takes the next
+///   piece as soon as it finishes one, with the best total found so far shared by all of them.
+/// Some of those threads can hand their pieces to helpers (other machines), which search the same way.
+template <std::size_t WORD_LENGTH>
+class TreeSearch {
+public:
+
+    /// \brief A cost too high ever to be the best, which is also the cost of a set that can not be solved in time.
+    static constexpr std::uint32_t INFEASIBLE = UINT32_MAX / 4;
+
+    /// \brief Somewhere else to solve the sets of answers that the first guess leaves.
+    /// Each helper is used by one thread at a time.  If a helper fails, that thread does the piece itself.
+    class Helpers {
+    public:
+
+        virtual ~Helpers () = default;
+
+        /// \brief Gets the number of helpers.
+        virtual std::size_t size () const = 0;
+
+        /// \brief Finds the cost of the best subtree for a set of answers, the way solve () does.
+        /// \param[in] helper Which helper to use.
+        /// \param[in] answers The set of answers.
+        /// \param[in] count The number of answers.
+        /// \param[in] guessesLeft The most guesses any of them may take.
+        /// \param[in] bound Only a cost below this matters.
+        /// \param[out] cost The cost, or something at least the bound.
+        /// \return True if the helper did it; false if it could not.
+        virtual bool solve (std::size_t helper, const std::uint32_t* answers, std::size_t count, unsigned int guessesLeft, std::uint64_t bound,
+                            std::uint64_t& cost) = 0;
+
+        /// \brief Finds the best subtree for a set of answers, the way subtree () does.
+        /// \param[in] helper Which helper to use.
+        /// \param[in] answers The set of answers.
+        /// \param[in] count The number of answers.
+        /// \param[in] guessesLeft The most guesses any of them may take.
+        /// \param[out] moves The subtree, as OpeningBook::writeMoves () writes it.
+        /// \param[out] worst The most guesses that any of the answers takes.
+        /// \return True if the helper did it; false if it could not.
+        virtual bool subtree (std::size_t helper, const std::uint32_t* answers, std::size_t count, unsigned int guessesLeft,
+                              std::string& moves, unsigned int& worst) = 0;
+    };
+
+    /// \brief Sets up a search.
+    /// \param[in] words The words that might be guessed and the words that might be the answer.
+    /// \param[in] strategy The strategy that decides which guesses are worth trying at each point.
+    /// \param[in] patterns The feedback for every allowed guess against every answer.
+    /// \param[in] breadth The number of guesses to try at each point.
+    /// \param[in] memoSize The most subtrees to remember.
+    /// \param[in] device A GPU to rank guesses for big sets of answers on, or nullptr to do it all on the CPU.
+    TreeSearch (const WordCollection<WORD_LENGTH>& words, const ScoringStrategy<WORD_LENGTH>& strategy, const PatternMatrix<WORD_LENGTH>& patterns,
+                std::size_t breadth, std::size_t memoSize, const DeviceScorer<WORD_LENGTH>* device = nullptr)
+    : m_words (words), m_strategy (strategy), m_patterns (patterns), m_device (device), m_breadth (std::max<std::size_t> (1, breadth)), m_memo (memoSize),
+      m_answerToGuess (words.m_answers.size ()) {
+        for (std::size_t answer = 0; answer < words.m_answers.size (); ++answer) {
+            m_answerToGuess[answer] = std::lower_bound (words.m_guesses.begin (), words.m_guesses.end (), words.m_answers[answer]) - words.m_guesses.begin ();
+        }
+    }
+
+    /// \brief Finds the best tree for all of the answers and adds every move in it to a book.
+    /// \param[in] maxGuesses The most guesses any answer may take.
+    /// \param[in] numThreads The number of threads to search with.
+    /// \param[in,out] book The book to add the moves to.
+    /// \param[out] worst The most guesses that any answer takes.
+    /// \param[in] helpers Helpers to share the work with, which add to the threads, or nullptr for none.
+    /// \return The total number of guesses over all answers, or INFEASIBLE if no tree the search tries is short enough.
+    std::uint32_t build (unsigned int maxGuesses, unsigned int numThreads, OpeningBook<WORD_LENGTH>& book, unsigned int& worst, Helpers* helpers = nullptr) {
+        assert (maxGuesses < OpeningBook<WORD_LENGTH>::MAX_DEPTH + 1);
+        std::vector<std::uint32_t> answers (m_words.m_answers.size ());
+        for (std::uint32_t answer = 0; answer < answers.size (); ++answer) { answers[answer] = answer; }
+        Result top = solveTop (answers, maxGuesses, numThreads, helpers);
+        worst = 0;
+        if (top.m_cost >= INFEASIBLE) { return INFEASIBLE; }
+        std::vector<Pattern<WORD_LENGTH>> history;
+        if (helpers && helpers->size () != 0) { emitTop (answers, maxGuesses, top, numThreads, *helpers, book, worst); }
+        else { emit (answers.data (), answers.size (), maxGuesses, top, history, book, worst); }
+        return top.m_cost;
+    }
+
+    /// \brief Finds the cost of the best subtree for a set of answers, for a helper.
+    /// \param[in] answers The set of answers, which must not be empty.
+    /// \param[in] count The number of answers.
+    /// \param[in] guessesLeft The most guesses any of them may take.
+    /// \param[in] bound Only a cost below this matters.
+    /// \return The cost, if it is below the bound; otherwise, a cost that is at least the bound.
+    std::uint32_t cost (const std::uint32_t* answers, std::size_t count, unsigned int guessesLeft, std::uint64_t bound) {
+        return solve (answers, count, guessesLeft, bound).m_cost;
+    }
+
+    /// \brief Finds the best subtree for a set of answers, for a helper.
+    /// \param[in] answers The set of answers, which must not be empty.
+    /// \param[in] count The number of answers.
+    /// \param[in] guessesLeft The most guesses any of them may take.
+    /// \param[out] moves The subtree, as OpeningBook::writeMoves () writes it, with histories that start from this set.
+    /// \param[out] worst The most guesses that any of the answers takes.
+    /// \return False if no subtree the search tries is short enough; true otherwise.
+    bool subtree (const std::uint32_t* answers, std::size_t count, unsigned int guessesLeft, std::string& moves, unsigned int& worst) {
+        Result here = solve (answers, count, guessesLeft, INFEASIBLE);
+        if (here.m_cost >= INFEASIBLE) { return false; }
+        OpeningBook<WORD_LENGTH> book (0, "");
+        std::vector<Pattern<WORD_LENGTH>> history;
+        worst = 0;
+        emit (answers, count, guessesLeft, here, history, book, worst);
+        std::ostringstream out;
+        book.writeMoves (out);
+        moves = out.str ();
+        return true;
+    }
+
+private:
+
+    /// \brief The best subtree for a set: its cost, and the index (in m_guesses) of its first guess.
+    struct Result {
+        std::uint32_t m_cost;
+        std::uint32_t m_guess;
+    };
+
+    /// \brief Marks a Result that has no guess, because nothing was good enough.
+    static constexpr std::uint32_t NO_GUESS = UINT32_MAX;
+
+    /// \brief The buckets that a guess splits a set of answers into.
+    /// The answers are grouped by feedback in m_answers, and bucket b is the m_sizes[b] of them
+    ///   starting at m_starts[b], with m_patterns[b] the feedback they all get.
+    /// The answers that the guess wins outright are left out, and bigger buckets come first.
+    struct Split {
+        std::vector<std::uint32_t> m_answers;
+        std::vector<Pattern<WORD_LENGTH>> m_patterns;
+        std::vector<std::uint32_t> m_starts;
+        std::vector<std::uint32_t> m_sizes;
+        /// \brief The cost of the guess itself plus the lower bound for every bucket.
+        std::uint64_t m_lowerBound;
+    };
+
+    /// \brief The least a set of answers could possibly cost.
+    static std::uint64_t lowerBound (std::size_t size) { return size == 0 ? 0 : 2 * size - 1; }
+
+    /// \brief Splits a set of answers up by the feedback a guess gets against each.
+    /// \param[in] guess The index of the guess.
+    /// \param[in] answers The set of answers.
+    /// \param[in] count The number of answers.
+    /// \param[out] split Where to put the buckets.
+    /// \return False if the guess tells us nothing (everything lands in one bucket); true otherwise.
+    bool splitBy (std::uint32_t guess, const std::uint32_t* answers, std::size_t count, Split& split) const {
+        std::uint32_t sizes[NUM_PATTERNS<WORD_LENGTH>] = {};
+        m_patterns.forEach (guess, answers, count, [&sizes] (Pattern<WORD_LENGTH> pattern) { ++sizes[pattern]; });
+        Pattern<WORD_LENGTH> first = m_patterns.at (guess, answers[0]);
+        if (sizes[first] == count && first != ALL_RIGHT<WORD_LENGTH>) { return false; }
+        split.m_patterns.clear ();
+        for (std::size_t pattern = 0; pattern < NUM_PATTERNS<WORD_LENGTH>; ++pattern) {
+            if (sizes[pattern] != 0 && pattern != ALL_RIGHT<WORD_LENGTH>) { split.m_patterns.push_back (pattern); }
+        }
+        std::stable_sort (split.m_patterns.begin (), split.m_patterns.end (), [&sizes] (Pattern<WORD_LENGTH> a, Pattern<WORD_LENGTH> b) {
+            return sizes[a] > sizes[b];
+        });
+        std::uint32_t starts[NUM_PATTERNS<WORD_LENGTH>];
+        split.m_starts.clear ();
+        split.m_sizes.clear ();
+        split.m_lowerBound = count;
+        std::uint32_t next = 0;
+        for (Pattern<WORD_LENGTH> pattern : split.m_patterns) {
+            starts[pattern] = next;
+            split.m_starts.push_back (next);
+            split.m_sizes.push_back (sizes[pattern]);
+            split.m_lowerBound += lowerBound (sizes[pattern]);
+            next += sizes[pattern];
+        }
+        split.m_answers.resize (next);
+        std::size_t a = 0;
+        m_patterns.forEach (guess, answers, count, [&] (Pattern<WORD_LENGTH> pattern) {
+            if (pattern != ALL_RIGHT<WORD_LENGTH>) { split.m_answers[starts[pattern]++] = answers[a]; }
+            ++a;
+        });
+        return true;
+    }
+
+    /// \brief Chooses the guesses worth trying for a set of answers.
+    /// \param[in] answers The set of answers.
+    /// \param[in] count The number of answers.
+    /// \param[out] ranked The best m_breadth guesses, best first.
+    /// Scores are the strategy's, and between equal scores a guess that might be the answer goes first.
+    /// For a big set, a device can rule out most of the guesses first, without changing which ones come out.
+    void rankGuesses (const std::uint32_t* answers, std::size_t count, std::vector<std::uint32_t>& ranked) const {
+        const std::vector<std::uint32_t>* candidates = &m_words.allGuesses ();
+        std::vector<std::uint32_t> shortlisted;
+        if (m_device && count >= DEVICE_MIN_ANSWERS && m_device->shortlist (answers, count, m_breadth, shortlisted)) { candidates = &shortlisted; }
+        std::vector<std::pair<std::pair<double, bool>, std::uint32_t>> scored (candidates->size ());
+        for (std::size_t c = 0; c < scored.size (); ++c) {
+            std::uint32_t guess = (*candidates)[c];
+            BucketCount buckets[NUM_PATTERNS<WORD_LENGTH>] = {};
+            m_patterns.forEach (guess, answers, count, [&buckets] (Pattern<WORD_LENGTH> pattern) { ++buckets[pattern]; });
+            scored[c] = {{m_strategy.score (buckets, count), buckets[ALL_RIGHT<WORD_LENGTH>] != 0}, guess};
+        }
+        std::size_t keep = std::min (m_breadth, scored.size ());
+        std::partial_sort (scored.begin (), scored.begin () + keep, scored.end (), [] (const std::pair<std::pair<double, bool>, std::uint32_t>& a,
+                                                                                        const std::pair<std::pair<double, bool>, std::uint32_t>& b) {
+            return a.first > b.first || (a.first == b.first && a.second < b.second);
+        });
+        ranked.clear ();
+        for (std::size_t g = 0; g < keep; ++g) { ranked.push_back (scored[g].second); }
+    }
+
+    /// \brief Computes a fingerprint for a set of answers with some number of guesses to go.
+    static std::uint64_t fingerprint (const std::uint32_t* answers, std::size_t count, unsigned int guessesLeft) {
+        std::uint64_t result = 14695981039346656037ull ^ guessesLeft;
+        for (std::size_t a = 0; a < count; ++a) {
+            std::uint64_t x = answers[a] * 0x9E3779B97F4A7C15ull;
+            x = (x ^ (x >> 29)) * 0xBF58476D1CE4E5B9ull;
+            result = (result ^ x ^ (x >> 32)) * 1099511628211ull;
+        }
+        return result;
+    }
+
+    /// \brief Finds the best subtree for a set of answers.
+    /// \param[in] answers The set of answers.
+    /// \param[in] count The number of answers, which must be at least one.
+    /// \param[in] guessesLeft The most guesses any of them may take.
+    /// \param[in] bound Only a cost below this matters.
+    /// \return The best subtree, if it costs less than the bound; otherwise, a cost that is at least the bound.
+    Result solve (const std::uint32_t* answers, std::size_t count, unsigned int guessesLeft, std::uint64_t bound) {
+        assert (count > 0);
+        if (guessesLeft == 0) { return {INFEASIBLE, NO_GUESS}; }
+        if (count == 1) { return {1, m_answerToGuess[answers[0]]}; }
+        if (guessesLeft == 1) { return {INFEASIBLE, NO_GUESS}; }
+        if (count == 2) { return {3, m_answerToGuess[answers[0]]}; }
+        bound = std::min<std::uint64_t> (bound, INFEASIBLE);
+        if (lowerBound (count) >= bound) { return {std::uint32_t (lowerBound (count)), NO_GUESS}; }
+
+        std::uint64_t key = fingerprint (answers, count, guessesLeft);
+        Result result;
+        if (m_memo.lookup (key, result)) { return result; }
+
+        // One of the answers might split up the rest completely, which is as good as it gets.
+        Split split;
+        for (std::size_t a = 0; a < count; ++a) {
+            std::uint32_t guess = m_answerToGuess[answers[a]];
+            if (splitBy (guess, answers, count, split) && split.m_sizes.size () == count - 1) {
+                return {std::uint32_t (lowerBound (count)), guess};
+            }
+        }
+        std::vector<std::uint32_t> ranked;
+        rankGuesses (answers, count, ranked);
+        result = {std::uint32_t (bound), NO_GUESS};
+        for (std::uint32_t guess : ranked) {
+            if (!splitBy (guess, answers, count, split) || split.m_lowerBound >= result.m_cost) { continue; }
+            std::uint64_t total = split.m_lowerBound;
+            for (std::size_t b = 0; b < split.m_sizes.size () && total < result.m_cost; ++b) {
+                if (split.m_sizes[b] == 1) { continue; }
+                total -= lowerBound (split.m_sizes[b]);
+                total += solve (&split.m_answers[split.m_starts[b]], split.m_sizes[b], guessesLeft - 1, result.m_cost - total).m_cost;
+            }
+            if (total < result.m_cost) {
+                result = {std::uint32_t (total), guess};
+                if (total == lowerBound (count)) { break; }
+            }
+        }
+        // A cost is only worth remembering if it is exact, which it is if something beat the bound,
+        //   or if nothing did and there was no bound to begin with.
+        if (result.m_guess != NO_GUESS || bound >= INFEASIBLE) {
+            if (result.m_guess == NO_GUESS) { result.m_cost = INFEASIBLE; }
+            m_memo.insert (key, result);
+        }
+        return result;
+    }
+
+    /// \brief Finds the best tree for all of the answers, spreading the work across threads.
+    /// \param[in] answers The set of answers.
+    /// \param[in] guessesLeft The most guesses any of them may take.
+    /// \param[in] numThreads The number of threads to use.
+    /// \param[in] helpers Helpers that more threads hand their pieces to, or nullptr for none.
+    /// \return The best tree.
+    /// Ties go to the guess that the strategy ranked higher, whichever thread gets there first,
+    ///   so the result does not depend on the number of threads, or on the helpers.
+    Result solveTop (const std::vector<std::uint32_t>& answers, unsigned int guessesLeft, unsigned int numThreads, Helpers* helpers) {
+        if (answers.size () <= 2 || guessesLeft <= 1) { return solve (answers.data (), answers.size (), guessesLeft, INFEASIBLE); }
+        std::vector<std::uint32_t> ranked;
+        rankGuesses (answers.data (), answers.size (), ranked);
+        std::vector<Split> splits (ranked.size ());
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> pieces;
+        for (std::uint32_t rank = 0; rank < ranked.size (); ++rank) {
+            if (!splitBy (ranked[rank], answers.data (), answers.size (), splits[rank])) {
+                splits[rank].m_lowerBound = INFEASIBLE;
+                continue;
+            }
+            for (std::uint32_t b = 0; b < splits[rank].m_sizes.size (); ++b) {
+                if (splits[rank].m_sizes[b] > 1) { pieces.push_back ({rank, b}); }
+            }
+        }
+        // Each guess's lower bound goes up as its buckets are solved exactly, and the best is packed as
+        //   (cost, rank) so that comparing two of them also breaks ties by rank.
+        std::vector<std::atomic<std::uint64_t>> lowerBounds (ranked.size ());
+        std::vector<std::atomic<std::uint32_t>> piecesLeft (ranked.size ());
+        std::vector<std::atomic<bool>> dropped (ranked.size ());
+        std::atomic<std::uint64_t> best (std::uint64_t (INFEASIBLE) << 32 | UINT32_MAX);
+        auto offer = [&best] (std::uint64_t cost, std::uint32_t rank) {
+            std::uint64_t packed = cost << 32 | rank;
+            std::uint64_t current = best.load ();
+            while (packed < current && !best.compare_exchange_weak (current, packed)) {}
+        };
+        for (std::uint32_t rank = 0; rank < ranked.size (); ++rank) {
+            lowerBounds[rank] = splits[rank].m_lowerBound;
+            piecesLeft[rank] = 0;
+            dropped[rank] = splits[rank].m_lowerBound >= INFEASIBLE;
+        }
+        for (const std::pair<std::uint32_t, std::uint32_t>& piece : pieces) { ++piecesLeft[piece.first]; }
+        for (std::uint32_t rank = 0; rank < ranked.size (); ++rank) {
+            if (!dropped[rank] && piecesLeft[rank] == 0) { offer (lowerBounds[rank], rank); }
+        }
+        std::atomic<std::size_t> nextPiece (0);
+        std::size_t numHelpers = helpers ? helpers->size () : 0;
+        std::size_t numWorkers = numHelpers + numThreads;
+        parallelForChunks (numWorkers, numWorkers, [&] (std::size_t worker, std::size_t) {
+            for (std::size_t p = nextPiece++; p < pieces.size (); p = nextPiece++) {
+                std::uint32_t rank = pieces[p].first;
+                const Split& split = splits[rank];
+                std::uint32_t b = pieces[p].second;
+                std::uint64_t others = lowerBounds[rank].load () - lowerBound (split.m_sizes[b]);
+                std::uint64_t current = best.load ();
+                std::uint64_t bestCost = current >> 32;
+                std::uint64_t limit = bestCost + (rank < (current & UINT32_MAX) ? 1 : 0);
+                bool keep = !dropped[rank] && others < limit;
+                if (keep) {
+                    const std::uint32_t* bucket = &split.m_answers[split.m_starts[b]];
+                    std::uint64_t cost;
+                    if (worker >= numHelpers || !helpers->solve (worker, bucket, split.m_sizes[b], guessesLeft - 1, limit - others, cost)) {
+                        cost = solve (bucket, split.m_sizes[b], guessesLeft - 1, limit - others).m_cost;
+                    }
+                    if (cost >= INFEASIBLE || cost >= limit - others) { keep = false; }
+                    else { lowerBounds[rank] += cost - lowerBound (split.m_sizes[b]); }
+                }
+                if (!keep) { dropped[rank] = true; }
+                if (--piecesLeft[rank] == 0 && !dropped[rank]) { offer (lowerBounds[rank], rank); }
+            }
+        });
+        std::uint64_t result = best.load ();
+        if ((result >> 32) >= INFEASIBLE) { return {INFEASIBLE, NO_GUESS}; }
+        return {std::uint32_t (result >> 32), ranked[result & UINT32_MAX]};
+    }
+
+    /// \brief Adds the best tree for all of the answers to a book, sharing out the subtrees for the first guess's buckets.
+    /// \param[in] answers The set of answers.
+    /// \param[in] guessesLeft The most guesses any of them may take.
+    /// \param[in] top The best tree, as found by solveTop ().
+    /// \param[in] numThreads The number of threads to use, besides the ones for the helpers.
+    /// \param[in,out] helpers The helpers.
+    /// \param[in,out] book The book to add the moves to.
+    /// \param[out] worst The most guesses any answer takes.
+    /// This adds the same moves that emit () would.
+    void emitTop (const std::vector<std::uint32_t>& answers, unsigned int guessesLeft, Result top, unsigned int numThreads, Helpers& helpers,
+                  OpeningBook<WORD_LENGTH>& book, unsigned int& worst) {
+        book.add (std::vector<Pattern<WORD_LENGTH>> (), m_words.m_guesses[top.m_guess]);
+        worst = 1;
+        Split split;
+        if (!splitBy (top.m_guess, answers.data (), answers.size (), split)) { return; }
+        std::vector<std::string> moves (split.m_sizes.size ());
+        std::vector<unsigned int> worsts (split.m_sizes.size (), 0);
+        std::atomic<std::size_t> nextBucket (0);
+        std::size_t numWorkers = helpers.size () + numThreads;
+        parallelForChunks (numWorkers, numWorkers, [&] (std::size_t worker, std::size_t) {
+            for (std::size_t b = nextBucket++; b < split.m_sizes.size (); b = nextBucket++) {
+                const std::uint32_t* bucket = &split.m_answers[split.m_starts[b]];
+                if (worker < helpers.size () && helpers.subtree (worker, bucket, split.m_sizes[b], guessesLeft - 1, moves[b], worsts[b])) { continue; }
+                bool found = subtree (bucket, split.m_sizes[b], guessesLeft - 1, moves[b], worsts[b]);
+                assert (found);
+                (void) found;
+            }
+        });
+        for (std::size_t b = 0; b < split.m_sizes.size (); ++b) {
+            std::vector<Pattern<WORD_LENGTH>> prefix (1, split.m_patterns[b]);
+            std::istringstream in (moves[b]);
+            if (!book.readMoves (in, prefix, &m_words.m_guesses)) {
+                // A helper's subtree that does not fit this dictionary is worked out here instead, which always fits.
+                bool found = subtree (&split.m_answers[split.m_starts[b]], split.m_sizes[b], guessesLeft - 1, moves[b], worsts[b]);
+                std::istringstream again (moves[b]);
+                bool read = found && book.readMoves (again, prefix, &m_words.m_guesses);
+                assert (read);
+                (void) read;
+            }
+            worst = std::max (worst, worsts[b] + 1);
+        }
+    }
+
+    /// \brief Adds a subtree to a book.
+    /// \param[in] answers The set of answers at this point.
+    /// \param[in] count The number of answers.
+    /// \param[in] guessesLeft The most guesses any of them may take.
+    /// \param[in] here The best subtree for the set, as found by solve ().
+    /// \param[in,out] history The feedback that leads here, which is restored before returning.
+    /// \param[in,out] book The book to add the moves to.
+    /// \param[in,out] worst The most guesses any answer takes so far.
+    /// Anything that fell out of the memo table is just searched for again.
+    void emit (const std::uint32_t* answers, std::size_t count, unsigned int guessesLeft, Result here,
+               std::vector<Pattern<WORD_LENGTH>>& history, OpeningBook<WORD_LENGTH>& book, unsigned int& worst) {
+        assert (here.m_guess != NO_GUESS);
+        book.add (history, m_words.m_guesses[here.m_guess]);
+        worst = std::max<unsigned int> (worst, history.size () + 1);
+        Split split;
+        if (!splitBy (here.m_guess, answers, count, split)) { return; }
+        for (std::size_t b = 0; b < split.m_sizes.size (); ++b) {
+            const std::uint32_t* bucket = &split.m_answers[split.m_starts[b]];
+            history.push_back (split.m_patterns[b]);
+            emit (bucket, split.m_sizes[b], guessesLeft - 1, solve (bucket, split.m_sizes[b], guessesLeft - 1, INFEASIBLE), history, book, worst);
+            history.pop_back ();
+        }
+    }
+
+    const WordCollection<WORD_LENGTH>& m_words;
+    const ScoringStrategy<WORD_LENGTH>& m_strategy;
+    const PatternMatrix<WORD_LENGTH>& m_patterns;
+    const DeviceScorer<WORD_LENGTH>* m_device;
+    std::size_t m_breadth;
+    MemoTable<Result> m_memo;
+    /// \brief For each answer, its index in m_guesses.
+    std::vector<std::uint32_t> m_answerToGuess;
+};
+
+
+/// \brief Searches for a decision tree and puts all of it in a book.
+/// \param[in] words The words that might be guessed and the words that might be the answer.
+/// \param[in] strategy The strategy that decides which guesses are worth trying.
+/// \param[in] patterns The feedback for every allowed guess against every answer.
+/// \param[in] minimax True to make the most guesses any answer takes as small as possible (and then the total);
+///   false to just make the total as small as possible.
+/// \param[in] breadth The number of guesses to try at each point.
+/// \param[in] memoSize The most subtrees to remember.
+/// \param[in] numThreads The number of threads to search with.
+/// \param[in,out] book The book to add the moves to.
+/// \param[in,out] log The stream to report on the tree to.
+/// \param[in] device A GPU to rank guesses on, or nullptr to do it all on the CPU.
+/// \param[in,out] helpers Other machines to share the search with, or nullptr to do it all here.
+/// \return True if it worked; false if none of the trees tried is short enough to fit in a book.
+/// For minimax, trees are searched for with one guess allowed, then two, and so on, and the first that works wins.
+template <std::size_t WORD_LENGTH>
+bool
+buildDecisionTree (const WordCollection<WORD_LENGTH>& words, const ScoringStrategy<WORD_LENGTH>& strategy, const PatternMatrix<WORD_LENGTH>& patterns,
+                   bool minimax, std::size_t breadth, std::size_t memoSize, unsigned int numThreads, OpeningBook<WORD_LENGTH>& book, std::ostream& log,
+                   const DeviceScorer<WORD_LENGTH>* device = nullptr, typename TreeSearch<WORD_LENGTH>::Helpers* helpers = nullptr) {
+    PROFILE_SCOPE (PHASE_BUILD_BOOK);
+    auto start = std::chrono::steady_clock::now ();
+    TreeSearch<WORD_LENGTH> search (words, strategy, patterns, breadth, memoSize, device);
+    const unsigned int deepest = OpeningBook<WORD_LENGTH>::MAX_DEPTH;
+    std::uint32_t total = TreeSearch<WORD_LENGTH>::INFEASIBLE;
+    unsigned int worst = 0;
+    for (unsigned int maxGuesses = minimax ? 1 : deepest; maxGuesses <= deepest && total >= TreeSearch<WORD_LENGTH>::INFEASIBLE; ++maxGuesses) {
+        total = search.build (maxGuesses, numThreads, book, worst, helpers);
+    }
+    if (total >= TreeSearch<WORD_LENGTH>::INFEASIBLE) {
+        log << "No decision tree that was tried solves every answer within " << deepest << " guesses; try a bigger --tree-breadth.\n";
+        return false;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds> (std::chrono::steady_clock::now () - start);
+    log << "Decision tree with " << book.size () << " moves takes " << double (total) / words.m_answers.size ()
+        << " guesses on average and " << worst << " at most, found in " << elapsed.count () << " ms\n";
+    return true;
+}
+
+
+/// \brief Everything that changes during a game.
+/// It is sized when it is created, so that resetting it and playing another game allocates nothing.
+/// It also reserves the calling thread's Scratch buffers, so it should be created on the thread that will use it.
+template <std::size_t WORD_LENGTH>
+struct GameState {
+
+    /// \brief Creates the state for the start of a game.
+    /// \param[in] words The word lists, which must outlive the state.
+    explicit GameState (const WordCollection<WORD_LENGTH>& words) : m_words (words), m_inPlay (words.start ()) {
+        m_history.reserve (MAX_SIMULATED_GUESSES);
+        Scratch::forThisThread ().reserve (words.m_guesses.size ());
+        ProjectedPatterns<WORD_LENGTH>::forThisThread ().reserve (words.m_guesses.size (), words.m_answers.size ());
+    }
+
+    /// \brief Goes back to the start of a game.
+    void reset () {
+        m_inPlay = m_words.start ();
+        m_knowledge.clear ();
+        m_history.clear ();
+    }
+
+    /// \brief The word lists, which every game shares.
+    const WordCollection<WORD_LENGTH>& m_words;
+    /// \brief The words that might still be the answer.
+    LiveWords m_inPlay;
+    /// \brief What we have learned so far.
+    Knowledge<WORD_LENGTH> m_knowledge;
+    /// \brief The feedback received so far, in order.
+    std::vector<Pattern<WORD_LENGTH>> m_history;
+};
+
+/// \brief Plays a whole game, working out the feedback ourselves instead of asking for it.
+/// \param[in] solver The way guesses are chosen.
+/// \param[in,out] state The state at the start of the game, which is updated as the game goes.
+/// \param[in] answer The secret word.
+/// \param[in,out] rng The random number generator used to break ties.
+/// \return The number of guesses it took, or 0 if the answer was ruled out.
+template <std::size_t WORD_LENGTH>
+int
+playGame (const Solver<WORD_LENGTH>& solver, GameState<WORD_LENGTH>& state, const Word<WORD_LENGTH>& answer, std::mt19937& rng) {
+    for (int numGuesses = 1; numGuesses <= MAX_SIMULATED_GUESSES; ++numGuesses) {
+        if (state.m_inPlay.m_possibleWords.none ()) { return 0; }
+        Word<WORD_LENGTH> guess = solver.chooseGuess (state.m_words, state.m_inPlay, state.m_history, rng);
+        if (guess == answer) { return numGuesses; }
+        Pattern<WORD_LENGTH> feedback = computeFeedback (guess, answer);
+        applyFeedback (state.m_knowledge, state.m_words, state.m_inPlay, guess, patternToString<WORD_LENGTH> (feedback));
+        assert (state.m_knowledge.satisfies (answer));
+        state.m_history.push_back (feedback);
+    }
+    return 0;
+}
+
+/// \brief Plays a game against each of a list of answers, and reports how well and how quickly that went.
+/// \param[in] solver The way guesses are chosen.  It should use one thread, since games are played in parallel.
+/// \param[in] words The words that might be the answer at the start of each game.
+/// \param[in] sampleSize The number of answers to try, or 0 to try every possible answer.
+/// \param[in] seed The seed for choosing the sample and for breaking ties in each game.
+/// \param[in] numThreads The number of games to play at once.
+/// \param[in,out] out The stream to write the report to.
+/// \param[in] allocationCount Gets the number of heap allocations the calling thread has made, or nullptr if the program does not count them.
+/// Each game gets its own random number generator, seeded from its answer, so the results do not depend on scheduling.
+/// Each thread sets up one GameState and reuses it, and if allocations are counted, the report says how many were made
+///   during games, which should be none.
+template <std::size_t WORD_LENGTH>
+void
+runBenchmark (const Solver<WORD_LENGTH>& solver, const WordCollection<WORD_LENGTH>& words, std::size_t sampleSize, unsigned int seed,
+              unsigned int numThreads, std::ostream& out, std::size_t (*allocationCount) () = nullptr) {
+    std::vector<std::uint32_t> answers (words.m_answers.size ());
+    for (std::size_t w = 0; w < answers.size (); ++w) { answers[w] = w; }
+    if (sampleSize != 0 && sampleSize < answers.size ()) {
+        std::mt19937 sampleRng (seed);
+        std::shuffle (answers.begin (), answers.end (), sampleRng);
+        answers.resize (sampleSize);
+        std::sort (answers.begin (), answers.end ());
+    }
+
+    std::vector<int> results (answers.size ());
+    std::vector<double> latencies (answers.size ());
+    std::vector<std::size_t> allocations (answers.size ());
+    std::atomic<std::size_t> nextGame (0);
+    auto start = std::chrono::steady_clock::now ();
+    parallelForChunks (numThreads, numThreads, [&] (std::size_t, std::size_t) {
+        GameState<WORD_LENGTH> state (words);
+        for (std::size_t game = nextGame++; game < answers.size (); game = nextGame++) {
+            std::mt19937 rng (seed + answers[game]);
+            std::size_t allocationsBefore = allocationCount ? allocationCount () : 0;
+            auto gameStart = std::chrono::steady_clock::now ();
+            state.reset ();
+            results[game] = playGame (solver, state, words.m_answers[answers[game]], rng);
+            PROFILE_COUNT (COUNT_GAMES, 1);
+            latencies[game] = std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - gameStart).count ();
+            allocations[game] = allocationCount ? allocationCount () - allocationsBefore : 0;
+        }
+    });
+    double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+
+    std::vector<std::size_t> histogram (MAX_SIMULATED_GUESSES + 1, 0);
+    std::size_t totalGuesses = 0, solved = 0, failures = 0;
+    for (int result : results) {
+        ++histogram[result];
+        if (result != 0) { totalGuesses += result; ++solved; }
+        if (result == 0 || result > MAX_GUESSES) { ++failures; }
+    }
+    std::sort (latencies.begin (), latencies.end ());
+    auto percentile = [&latencies] (double p) {
+        return latencies.empty () ? 0.0 : latencies[std::min (latencies.size () - 1, std::size_t (p * latencies.size ()))];
+    };
+
+    out << "Played " << answers.size () << " games with the " << solver.name () << " strategy" << (words.m_hardMode ? " in hard mode" : "") << " in " << seconds
+        << " s (" << answers.size () / seconds << " games/s)\n";
+    out << "Guesses needed:\n";
+    for (int guesses = 1; guesses <= MAX_SIMULATED_GUESSES; ++guesses) {
+        if (histogram[guesses] != 0) { out << "  " << guesses << ": " << histogram[guesses] << "\n"; }
+    }
+    if (histogram[0] != 0) { out << "  lost the answer: " << histogram[0] << "\n"; }
+    out << "Average guesses when solved: " << (solved == 0 ? 0.0 : double (totalGuesses) / solved) << "\n";
+    out << "Failed (not solved in " << MAX_GUESSES << "): " << failures << " ("
+        << (answers.empty () ? 0.0 : 100.0 * failures / answers.size ()) << "%)\n";
+    out << "Latency per game: p50 " << percentile (0.50) << " ms, p99 " << percentile (0.99) << " ms\n";
+    if (allocationCount) {
+        std::size_t totalAllocations = 0, gamesThatAllocated = 0;
+        for (std::size_t count : allocations) {
+            totalAllocations += count;
+            if (count != 0) { ++gamesThatAllocated; }
+        }
+        out << "Heap allocations during games: " << totalAllocations << " (in " << gamesThatAllocated << " games)\n";
+    }
+    if (solver.m_shortlistStats) {
+        const ShortlistStats& stats = *solver.m_shortlistStats;
+        out << "Shortlist of " << solver.m_shortlistSize << " (sampling 1 in " << solver.m_sampleStride << "): " << stats.m_choices
+            << " choices, best guess missed in " << stats.m_misses << " ("
+            << (stats.m_choices == 0 ? 0.0 : 100.0 * stats.m_misses / stats.m_choices) << "%), "
+            << (stats.m_shortlistNanoseconds == 0 ? 0.0 : double (stats.m_exactNanoseconds) / stats.m_shortlistNanoseconds)
+            << "x faster than scoring every guess\n";
+    }
+    if (solver.m_anytimeStats) {
+        const AnytimeStats& stats = *solver.m_anytimeStats;
+        double choices = std::max<std::size_t> (1, stats.m_choices);
+        out << "Deadline of " << std::chrono::duration_cast<std::chrono::microseconds> (solver.m_deadline).count () << " us: " << stats.m_choices
+            << " choices, " << stats.m_evaluated / choices << " of " << stats.m_candidates / choices << " guesses scored on average, cut off in "
+            << stats.m_cutOff << " (" << 100.0 * stats.m_cutOff / choices << "%), best guess missed in " << stats.m_misses << " ("
+            << 100.0 * stats.m_misses / choices << "%), " << stats.m_nanoseconds / choices / 1000.0 << " us per choice\n";
+    }
+    if (solver.m_memo) {
+        out << "Memo table: " << solver.m_memo->hits () << " hits, " << solver.m_memo->misses () << " misses, "
+            << solver.m_memo->evictions () << " evictions\n";
+    }
+}
+
+
+/// \brief Several puzzles that are played at once with the same guesses, as in Quordle (four boards) or Octordle (eight).
+/// Every board shares the word lists and the feedback patterns, and only has its own set of possible answers
+///   and what has been learned about it, so adding boards costs a bitset and a Knowledge each.
+template <std::size_t WORD_LENGTH>
+class MultiBoardState {
+public:
+
+    /// \brief Creates the state for the start of a game.
+    /// \param[in] words The words that might be the answer on each board at the start of the game.
+    /// \param[in] numBoards The number of boards.
+    MultiBoardState (const WordCollection<WORD_LENGTH>& words, std::size_t numBoards)
+    : m_possible (numBoards, words.start ().m_possibleWords), m_knowledge (numBoards), m_solved (numBoards, false) {
+        m_live.reserve (numBoards);
+        m_weights.reserve (numBoards);
+        m_lists.resize (numBoards);
+        for (std::vector<std::uint32_t>& list : m_lists) { list.reserve (words.m_answers.size ()); }
+    }
+
+    /// \brief Goes back to the start of a game.
+    /// \param[in] words The words that might be the answer at the start of the game, which must be the same lists as before.
+    void reset (const WordCollection<WORD_LENGTH>& words) {
+        for (std::size_t board = 0; board < numBoards (); ++board) {
+            m_possible[board] = words.start ().m_possibleWords;
+            m_knowledge[board].clear ();
+            m_solved[board] = false;
+        }
+    }
+
+    /// \brief Gets the number of boards.
+    std::size_t numBoards () const { return m_possible.size (); }
+
+    /// \brief Counts the boards that have not been solved yet.
+    std::size_t numUnsolved () const { return std::count (m_solved.begin (), m_solved.end (), false); }
+
+    /// \brief Chooses the next guess, scoring each allowed guess once against every board that is still unsolved.
+    /// \param[in] words The word lists.
+    /// \param[in] strategy The way of scoring a guess on one board; the scores on the boards are added up.
+    /// \param[in] patterns The feedback for every allowed guess against every answer.
+    /// \param[in,out] rng The random number generator used to break ties.
+    /// \param[in] numThreads The number of threads to score guesses with.
+    /// \return A word from the list of allowed guesses.
+    /// If a board is down to one possible answer, that is the guess, since it solves a board without fail and still
+    ///   tells us something about the others.
+    /// Otherwise each guess's row of patterns is read once and put into buckets for each board in turn.
+    /// Boards that have the same possible answers (which at the start of a game is all of them) are only
+    ///   scored once and counted as many times as there are of them.
+    /// Between equally good guesses, one that might be the answer on more boards is preferred.
+    Word<WORD_LENGTH> chooseGuess (const WordCollection<WORD_LENGTH>& words, const ScoringStrategy<WORD_LENGTH>& strategy,
+                                   const PatternMatrix<WORD_LENGTH>& patterns, std::mt19937& rng, unsigned int numThreads = 1) {
+        assert (patterns.numGuesses () == words.m_guesses.size () && patterns.numAnswers () == words.m_answers.size ());
+        PROFILE_SCOPE (PHASE_CHOOSE_GUESS);
+        m_live.clear ();
+        m_weights.clear ();
+        for (std::size_t board = 0; board < numBoards (); ++board) {
+            if (m_solved[board]) { continue; }
+            assert (!m_possible[board].none ());
+            if (m_possible[board].count () == 1) {
+                std::uint32_t only = 0;
+                m_possible[board].forEach ([&only] (std::size_t answer) { only = answer; });
+                return words.m_answers[only];
+            }
+            std::size_t same = 0;
+            while (same < m_live.size () && !(m_possible[m_live[same]] == m_possible[board])) { ++same; }
+            if (same < m_live.size ()) { ++m_weights[same]; }
+            else {
+                m_possible[board].indices (m_lists[board]);
+                m_live.push_back (board);
+                m_weights.push_back (1);
+            }
+        }
+        assert (!m_live.empty ());
+        std::size_t work = 0;
+        for (std::size_t board : m_live) { work += m_lists[board].size () * words.m_guesses.size (); }
+        PROFILE_SCOPE (PHASE_SCORE_GUESSES);
+        PROFILE_COUNT (COUNT_GUESSES_SCORED, words.m_guesses.size ());
+        PROFILE_COUNT (COUNT_PATTERN_LOOKUPS, work);
+        unsigned int threads = work < PARALLEL_PATTERN_THRESHOLD ? 1 : numThreads;
+        std::uint32_t best = chooseBest<std::pair<double, unsigned int>> (words.allGuesses (), threads, [&] (std::uint32_t guess) {
+            double total = 0.0;
+            unsigned int possible = 0;
+            for (std::size_t live = 0; live < m_live.size (); ++live) {
+                const std::vector<std::uint32_t>& list = m_lists[m_live[live]];
+                BucketCount buckets[NUM_PATTERNS<WORD_LENGTH>] = {};
+                patterns.forEach (guess, list.data (), list.size (), [&buckets] (Pattern<WORD_LENGTH> pattern) { ++buckets[pattern]; });
+                total += m_weights[live] * strategy.score (buckets, list.size ());
+                if (words.isIn (guess, m_possible[m_live[live]])) { possible += m_weights[live]; }
+            }
+            return std::make_pair (total, possible);
+        }, rng);
+        return words.m_guesses[best];
+    }
+
+    /// \brief Updates one board after getting feedback on a guess.
+    /// \param[in] words The word lists.
+    /// \param[in] board The board the feedback is for, which must not be solved yet.
+    /// \param[in] guess The word that was guessed.
+    /// \param[in] feedback The response that board gave.
+    void applyFeedback (const WordCollection<WORD_LENGTH>& words, std::size_t board, const Word<WORD_LENGTH>& guess, const std::string& feedback) {
+        assert (!m_solved[board]);
+        if (feedback == std::string (WORD_LENGTH, RIGHT_SPOT)) {
+            m_solved[board] = true;
+            return;
+        }
+        PROFILE_SCOPE (PHASE_APPLY_FEEDBACK);
+        PROFILE_COUNT (COUNT_FEEDBACK, 1);
+#ifdef CHWORDLEBOT_PROFILE
+        std::size_t remaining = m_possible[board].count ();
+#endif
+        Knowledge<WORD_LENGTH> before = m_knowledge[board];
+        m_knowledge[board].addFeedback (guess, feedback);
+        m_knowledge[board].narrow (before, words.m_letterIndex, m_possible[board]);
+        PROFILE_COUNT (COUNT_WORDS_ELIMINATED, remaining - m_possible[board].count ());
+    }
+
+    /// \brief The indices of the words that might still be the answer on each board.
+    std::vector<Bitset> m_possible;
+    /// \brief What we have learned about each board.
+    std::vector<Knowledge<WORD_LENGTH>> m_knowledge;
+    /// \brief Which boards have been solved, and so drop out of choosing guesses.
+    std::vector<bool> m_solved;
+
+private:
+
+    /// \brief The unsolved boards that chooseGuess () scores, with no two having the same possible answers.
+    std::vector<std::size_t> m_live;
+    /// \brief How many unsolved boards each of those stands for.
+    std::vector<unsigned int> m_weights;
+    /// \brief The possible answers on each board as a list, which is quicker to go through once per guess.
+    std::vector<std::vector<std::uint32_t>> m_lists;
+};
+
+/// \brief The number of multi-board games to benchmark when no sample size is given.
+const std::size_t DEFAULT_MULTI_BOARD_GAMES = 1000;
+
+/// \brief The most guesses a real multi-board game allows, which is one more for each extra board (9 for Quordle, 13 for Octordle).
+inline int
+maxMultiBoardGuesses (std::size_t numBoards) {
+    return MAX_GUESSES + numBoards - 1;
+}
+
+/// \brief Plays a whole multi-board game, working out the feedback ourselves instead of asking for it.
+/// \param[in] words The word lists.
+/// \param[in] strategy The way of scoring guesses.
+/// \param[in] patterns The feedback for every allowed guess against every answer.
+/// \param[in,out] state The state at the start of the game, which is updated as the game goes.
+/// \param[in] answers The index (in words.m_answers) of the secret word on each board.
+/// \param[in] opening The first guess, which is the same every game and so can be chosen once ahead of time.
+/// \param[in,out] rng The random number generator used to break ties.
+/// \return The number of guesses it took to solve every board, or 0 if some board's answer was ruled out.
+template <std::size_t WORD_LENGTH>
+int
+playMultiBoardGame (const WordCollection<WORD_LENGTH>& words, const ScoringStrategy<WORD_LENGTH>& strategy, const PatternMatrix<WORD_LENGTH>& patterns,
+                    MultiBoardState<WORD_LENGTH>& state, const std::vector<std::uint32_t>& answers, const Word<WORD_LENGTH>& opening, std::mt19937& rng) {
+    for (int numGuesses = 1; numGuesses <= MAX_SIMULATED_GUESSES; ++numGuesses) {
+        for (std::size_t board = 0; board < state.numBoards (); ++board) {
+            if (!state.m_solved[board] && state.m_possible[board].none ()) { return 0; }
+        }
+        Word<WORD_LENGTH> guess = numGuesses == 1 ? opening : state.chooseGuess (words, strategy, patterns, rng);
+        for (std::size_t board = 0; board < state.numBoards (); ++board) {
+            if (state.m_solved[board]) { continue; }
+            const Word<WORD_LENGTH>& answer = words.m_answers[answers[board]];
+            state.applyFeedback (words, board, guess, patternToString<WORD_LENGTH> (computeFeedback (guess, answer)));
+            assert (state.m_solved[board] || state.m_knowledge[board].satisfies (answer));
+        }
+        if (state.numUnsolved () == 0) { return numGuesses; }
+    }
+    return 0;
+}
+
+/// \brief Plays a number of multi-board games with random answers, and reports how well and how quickly that went.
+/// \param[in] words The word lists.
+/// \param[in] strategy The way of scoring guesses.
+/// \param[in] patterns The feedback for every allowed guess against every answer.
+/// \param[in] numBoards The number of boards in each game.
+/// \param[in] numGames The number of games to play.
+/// \param[in] seed The seed for choosing the answers and for breaking ties in each game.
+/// \param[in] numThreads The number of games to play at once.
+/// \param[in,out] out The stream to write the report to.
+/// Each game's answers are different from each other, and come from its own random number generator, so the
+///   results do not depend on scheduling.
+template <std::size_t WORD_LENGTH>
+void
+runMultiBoardBenchmark (const WordCollection<WORD_LENGTH>& words, const ScoringStrategy<WORD_LENGTH>& strategy, const PatternMatrix<WORD_LENGTH>& patterns,
+                        std::size_t numBoards, std::size_t numGames, unsigned int seed, unsigned int numThreads, std::ostream& out) {
+    numBoards = std::min (numBoards, words.m_answers.size ());
+    std::mt19937 openingRng (seed);
+    MultiBoardState<WORD_LENGTH> start (words, numBoards);
+    Word<WORD_LENGTH> opening = start.chooseGuess (words, strategy, patterns, openingRng, numThreads);
+
+    std::vector<int> results (numGames);
+    std::atomic<std::size_t> nextGame (0);
+    auto startTime = std::chrono::steady_clock::now ();
+    parallelForChunks (numThreads, numThreads, [&] (std::size_t, std::size_t) {
+        MultiBoardState<WORD_LENGTH> state (words, numBoards);
+        std::vector<std::uint32_t> answers;
+        for (std::size_t game = nextGame++; game < numGames; game = nextGame++) {
+            std::mt19937 rng (seed + game);
+            answers.clear ();
+            while (answers.size () < numBoards) {
+                std::uint32_t answer = std::uniform_int_distribution<std::uint32_t> (0, words.m_answers.size () - 1) (rng);
+                if (std::find (answers.begin (), answers.end (), answer) == answers.end ()) { answers.push_back (answer); }
+            }
+            state.reset (words);
+            results[game] = playMultiBoardGame (words, strategy, patterns, state, answers, opening, rng);
+            PROFILE_COUNT (COUNT_GAMES, 1);
+        }
+    });
+    double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - startTime).count ();
+
+    std::vector<std::size_t> histogram (MAX_SIMULATED_GUESSES + 1, 0);
+    std::size_t totalGuesses = 0, solved = 0, failures = 0;
+    for (int result : results) {
+        ++histogram[result];
+        if (result != 0) { totalGuesses += result; ++solved; }
+        if (result == 0 || result > maxMultiBoardGuesses (numBoards)) { ++failures; }
+    }
+    out << "Played " << numGames << " games on " << numBoards << " boards with the " << strategy.name () << " strategy in " << seconds
+        << " s (" << numGames / seconds << " games/s), opening with " << opening << "\n";
+    out << "Guesses needed:\n";
+    for (int guesses = 1; guesses <= MAX_SIMULATED_GUESSES; ++guesses) {
+        if (histogram[guesses] != 0) { out << "  " << guesses << ": " << histogram[guesses] << "\n"; }
+    }
+    if (histogram[0] != 0) { out << "  lost an answer: " << histogram[0] << "\n"; }
+    out << "Average guesses when solved: " << (solved == 0 ? 0.0 : double (totalGuesses) / solved) << "\n";
+    out << "Failed (not solved in " << maxMultiBoardGuesses (numBoards) << "): " << failures << " ("
+        << (numGames == 0 ? 0.0 : 100.0 * failures / numGames) << "%)\n";
+}
+
+/// \brief Gets the feedback patterns for some word lists ready, from a cache if there is a good one.
+/// \param[in] words The word lists.
+/// \param[in] cacheName The file the patterns are cached in.
+/// \param[in] budget The most memory, in bytes, that the patterns may take before they are worked out as needed instead.
+/// \param[in] numThreads The number of threads to build them with.
+/// \param[in,out] log Where to say how it went.
+/// \return The patterns.
+template <std::size_t WORD_LENGTH>
+std::unique_ptr<PatternMatrix<WORD_LENGTH>>
+preparePatterns (const WordCollection<WORD_LENGTH>& words, const std::string& cacheName, std::size_t budget, unsigned int numThreads,
+                 std::ostream& log) {
+    std::unique_ptr<PatternMatrix<WORD_LENGTH>> patterns;
+    std::size_t size = PatternMatrix<WORD_LENGTH>::storedSize (words.m_guesses.size (), words.m_answers.size ());
+    if (size > budget) {
+        // Too big to keep, so every score will work its feedback out again; that is slower, but it does not run out of memory.
+        patterns = PatternMatrix<WORD_LENGTH>::onTheFly (words.m_guesses, words.m_answers);
+        log << "Feedback patterns for " << patterns->numGuesses () << " x " << patterns->numAnswers () << " words would take "
+            << (size >> 20) << " MB, more than the budget of " << (budget >> 20) << " MB, so they will be worked out as needed\n";
+    }
+    else {
+        auto start = std::chrono::steady_clock::now ();
+        patterns = PatternMatrix<WORD_LENGTH>::loadOrBuild (cacheName, words.m_guesses, words.m_answers, numThreads);
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds> (std::chrono::steady_clock::now () - start);
+        log << "Feedback patterns for " << patterns->numGuesses () << " x " << patterns->numAnswers ()
+            << " words ready in " << elapsed.count () << " ms\n";
+    }
+    return patterns;
+}
+
+
+template <std::size_t WORD_LENGTH> class Dictionary;
+
+/// \brief One game played against a shared Dictionary.
+/// It holds only what the game has ruled out: the set of possible answers (with their letter counts), the guesses
+///   hard mode still allows, the constraints learned so far, and the feedback history, so copying one to try something
+///   out is a copy of two bitsets and a few small arrays.
+/// The dictionary must outlive its sessions.  Different sessions can be used on different threads at once,
+///   but one session can only be used by one thread at a time.
+template <std::size_t WORD_LENGTH>
+class GameSession {
+public:
+
+    /// \brief Starts a game.
+    /// \param[in] dictionary The words, and the way guesses are chosen.
+    explicit GameSession (const Dictionary<WORD_LENGTH>& dictionary) : m_dictionary (&dictionary) { restart (); }
+
+    /// \brief Goes back to the start of the game, with every word possible again.
+    void restart () {
+        m_inPlay = m_dictionary->words ().start ();
+        m_knowledge.clear ();
+        m_history.clear ();
+    }
+
+    /// \brief Makes a copy of the game as it stands, which goes its own way from here.
+    GameSession<WORD_LENGTH> fork () const { return *this; }
+
+    /// \brief Chooses the next guess.
+    /// \param[in,out] rng The random number generator used to break ties.
+    /// \return The word to guess.
+    /// There must be at least one possible answer left.
+    Word<WORD_LENGTH> suggest (std::mt19937& rng) {
+        assert (!m_inPlay.m_possibleWords.none ());
+        m_dictionary->prepareThread ();
+        return m_dictionary->solver ().chooseGuess (m_dictionary->words (), m_inPlay, m_history, rng);
+    }
+
+    /// \brief Rules out what the feedback on a guess says cannot be the answer.
+    /// \param[in] guess The word that was guessed, which need not be one that was suggested.
+    /// \param[in] feedback The response that was received about the guess, like WWYWG.
+    /// \return True if some word in the dictionary still fits everything, or false if the feedback must have been wrong.
+    bool observe (const Word<WORD_LENGTH>& guess, const std::string& feedback) {
+        assert (feedback.length () == WORD_LENGTH);
+        m_dictionary->prepareThread ();
+        applyFeedback (m_knowledge, m_dictionary->words (), m_inPlay, guess, feedback);
+        m_history.push_back (patternFromString<WORD_LENGTH> (feedback));
+        return !m_inPlay.m_possibleWords.none ();
+    }
+
+    /// \brief Gets the number of words that might still be the answer.
+    std::size_t numPossible () const { return m_inPlay.m_possibleWords.count (); }
+
+    /// \brief Gets the number of guesses that have had feedback.
+    std::size_t numGuesses () const { return m_history.size (); }
+
+    /// \brief Gets the feedback received so far, in order.
+    const std::vector<Pattern<WORD_LENGTH>>& history () const { return m_history; }
+
+    /// \brief Gets what has been learned so far.
+    const Knowledge<WORD_LENGTH>& knowledge () const { return m_knowledge; }
+
+private:
+    const Dictionary<WORD_LENGTH>* m_dictionary;
+    /// \brief The answers that might still be right, how many of each letter they have, and the guesses that hard mode still allows.
+    LiveWords m_inPlay;
+    Knowledge<WORD_LENGTH> m_knowledge;
+    std::vector<Pattern<WORD_LENGTH>> m_history;
+};
+
+
+/// \brief Everything about a set of words that stays the same from one game to the next: the packed word lists and their
+///   indexes, the feedback patterns, and the way guesses are chosen.
+/// Once it has been set up nothing changes it, so any number of threads can play any number of GameSessions against it;
+///   each session keeps the words it still has in play, and hands them to the shared word lists with each call.
+template <std::size_t WORD_LENGTH>
+class Dictionary {
+public:
+
+    /// \brief Sets up a dictionary.
+    /// \param[in] words The word lists, which become the dictionary's own.
+    /// \param[in] strategy The way of scoring guesses, or nullptr to use the letter-frequency heuristic.
+    /// \param[in] patterns The feedback for every allowed guess against every answer, which is needed if there is a strategy.
+    /// \param[in] numThreads The number of threads to use when choosing each guess.
+    Dictionary (WordCollection<WORD_LENGTH> words, std::unique_ptr<ScoringStrategy<WORD_LENGTH>> strategy,
+                std::unique_ptr<PatternMatrix<WORD_LENGTH>> patterns, unsigned int numThreads = 1)
+    : m_words (std::move (words)), m_strategy (std::move (strategy)), m_patterns (std::move (patterns)),
+      m_solver {m_strategy.get (), m_patterns.get (), numThreads} {
+        assert (!m_strategy || m_patterns);
+    }
+
+    Dictionary (const Dictionary<WORD_LENGTH>&) = delete;
+    Dictionary<WORD_LENGTH>& operator= (const Dictionary<WORD_LENGTH>&) = delete;
+
+    /// \brief Gets the word lists.
+    const WordCollection<WORD_LENGTH>& words () const { return m_words; }
+
+    /// \brief Gets the way of scoring guesses, or nullptr if it is the letter-frequency heuristic.
+    const ScoringStrategy<WORD_LENGTH>* strategy () const { return m_strategy.get (); }
+
+    /// \brief Gets the feedback patterns, or nullptr if there is no strategy that needs them.
+    const PatternMatrix<WORD_LENGTH>* patterns () const { return m_patterns.get (); }
+
+    /// \brief Gets the way guesses are chosen.
+    const Solver<WORD_LENGTH>& solver () const { return m_solver; }
+
+    /// \brief Gets the way guesses are chosen, to give it a book, a memo table, and so on before any games start.
+    Solver<WORD_LENGTH>& solver () { return m_solver; }
+
+private:
+    friend class GameSession<WORD_LENGTH>;
+
+    /// \brief Makes sure the calling thread's buffers are big enough, since games can move from one thread to another.
+    void prepareThread () const {
+        Scratch::forThisThread ().reserve (m_words.m_guesses.size ());
+        ProjectedPatterns<WORD_LENGTH>::forThisThread ().reserve (m_words.m_guesses.size (), m_words.m_answers.size ());
+    }
+
+    WordCollection<WORD_LENGTH> m_words;
+    std::unique_ptr<ScoringStrategy<WORD_LENGTH>> m_strategy;
+    std::unique_ptr<PatternMatrix<WORD_LENGTH>> m_patterns;
+    Solver<WORD_LENGTH> m_solver;
+};
+
+
+#endif
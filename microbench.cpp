@@ -0,0 +1,206 @@
+/// \file microbench.cpp
+/// \author Chad Hogg
+/// \version 2026-10-14
+/// Times the pieces of chwordlebot one at a time, so that a change to one of them can be measured
+///   without playing whole games.
+/// Each kernel is run on the dictionary given on the command line (the bundled words by default) and on made-up
+///   dictionaries of other sizes, whose words are drawn from the same letter frequencies in each position.
+/// It is built from the same engine as the bot:
+///     g++ -std=c++17 -O2 -march=native -pthread microbench.cpp -o microbench
+
+#include <iomanip>
+#include <unordered_set>
+
+#include "chwordlebot.h"
+
+/// \brief The word length the benchmarks use.
+const std::size_t BENCH_LENGTH = 5;
+/// \brief The sizes of the made-up dictionaries if none are given.
+const std::vector<std::size_t> DEFAULT_SYNTHETIC_SIZES = {50000, 200000};
+/// \brief How long each kernel runs for, at least, if not specified.
+const double DEFAULT_MIN_SECONDS = 0.25;
+/// \brief The most answers the pattern matrix and entropy benchmarks use, which keeps the matrix for 200k guesses at 100 MB.
+const std::size_t MAX_BENCH_ANSWERS = 512;
+/// \brief The number of guesses the benchmark with every word as an answer scores.
+const std::size_t WIDE_BENCH_GUESSES = 16;
+
+typedef Word<BENCH_LENGTH> BenchWord;
+
+/// \brief Runs a kernel over and over until enough time has passed, and reports how long each run took.
+/// \param[in] name The name of the kernel.
+/// \param[in] dictionaryName What the kernel ran on.
+/// \param[in] itemsPerRun How many things (words, pairs, ...) one run handles, for the throughput.
+/// \param[in] itemName What those things are called.
+/// \param[in] minSeconds The least time to spend.
+/// \param[in] kernel The kernel, which returns something that depends on its work so that it is not optimized away.
+template <typename Kernel>
+void
+timeKernel (const std::string& name, const std::string& dictionaryName, std::size_t itemsPerRun, const std::string& itemName, double minSeconds,
+            Kernel kernel) {
+    std::uint64_t sink = kernel ();
+    std::size_t runs = 0;
+    auto start = std::chrono::steady_clock::now ();
+    double seconds = 0.0;
+    while (seconds < minSeconds) {
+        sink += kernel ();
+        ++runs;
+        seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+    }
+    double nanoseconds = seconds * 1e9 / runs;
+    std::cout << std::left << std::setw (18) << name << std::setw (16) << dictionaryName << std::right
+              << std::setw (14) << std::fixed << std::setprecision (1) << nanoseconds << " ns/op"
+              << std::setw (14) << std::setprecision (2) << itemsPerRun / nanoseconds * 1e3 << " M" << itemName << "/s"
+              << "  (" << runs << " runs, check " << (sink & 0xFFFF) << ")\n";
+    std::cout.unsetf (std::ios::floatfield);
+}
+
+/// \brief Makes up a dictionary with the same letter frequencies in each position as a real one.
+/// \param[in] real The dictionary to copy the frequencies from.
+/// \param[in] size The number of different words to make.
+/// \param[in] seed The seed for the random number generator.
+/// \return The words, in no particular order.
+std::vector<BenchWord>
+syntheticDictionary (const std::vector<BenchWord>& real, std::size_t size, unsigned int seed) {
+    std::vector<std::discrete_distribution<int>> letters;
+    for (unsigned short index = 0; index < BENCH_LENGTH; ++index) {
+        std::vector<double> counts (ALPHABET_SIZE, 1.0);
+        for (const BenchWord& word : real) { ++counts[word.code (index)]; }
+        letters.emplace_back (counts.begin (), counts.end ());
+    }
+    std::mt19937 rng (seed);
+    std::unordered_set<BenchWord> seen;
+    std::vector<BenchWord> result;
+    while (result.size () < size) {
+        std::string text (BENCH_LENGTH, ' ');
+        for (unsigned short index = 0; index < BENCH_LENGTH; ++index) { text[index] = 'A' + letters[index] (rng); }
+        BenchWord word (text);
+        if (seen.insert (word).second) { result.push_back (word); }
+    }
+    return result;
+}
+
+/// \brief Runs every kernel on one dictionary.
+/// \param[in] name What to call the dictionary in the report.
+/// \param[in] dictionary The words.
+/// \param[in] minSeconds The least time to spend on each kernel.
+void
+benchDictionary (const std::string& name, const std::vector<BenchWord>& dictionary, double minSeconds) {
+    std::mt19937 rng (1);
+
+    // Parsing: the text of the dictionary, one word per line, the way the bot reads a plain word list.
+    std::string text;
+    for (const BenchWord& word : dictionary) { text += word.toString () + "\n"; }
+    timeKernel ("parse", name, dictionary.size (), "words", minSeconds, [&text] () {
+        return std::uint64_t (parseWordList<BENCH_LENGTH> (text.data (), text.data () + text.size ()).size ());
+    });
+
+    // Loading: the whole of loadDictionary () on a preprocessed copy, which is mapping, copying, and checking the words.
+    char binaryName[] = "/tmp/microbench-XXXXXX";
+    int fd = mkstemp (binaryName);
+    if (fd >= 0) {
+        close (fd);
+        std::vector<BenchWord> sorted = dictionary;
+        std::sort (sorted.begin (), sorted.end ());
+        if (saveDictionary (binaryName, sorted)) {
+            std::vector<BenchWord> loaded;
+            timeKernel ("load binary", name, dictionary.size (), "words", minSeconds, [&] () {
+                return std::uint64_t (loadDictionary (binaryName, loaded) ? loaded.size () : 0);
+            });
+        }
+        unlink (binaryName);
+    }
+
+    WordCollection<BENCH_LENGTH> words (dictionary);
+    Scratch::forThisThread ().reserve (words.m_guesses.size ());
+
+    // Feedback: one guess against every word, a pair at a time and a row at a time.
+    const BenchWord guess = words.m_answers[words.m_answers.size () / 2];
+    timeKernel ("feedback", name, words.m_answers.size (), "pairs", minSeconds, [&] () {
+        std::uint64_t total = 0;
+        for (const BenchWord& answer : words.m_answers) { total += computeFeedback (guess, answer); }
+        return total;
+    });
+    std::vector<Pattern<BENCH_LENGTH>> row (words.m_answers.size ());
+    timeKernel ("feedback row", name, words.m_answers.size (), "pairs", minSeconds, [&] () {
+        computeFeedbackRow (guess, words.m_answers.data (), words.m_answers.size (), row.data ());
+        return std::uint64_t (row[row.size () / 3]);
+    });
+
+    // Filtering: the feedback on a first guess applied to the whole dictionary.
+    std::vector<std::string> feedback (64);
+    for (std::string& f : feedback) {
+        const BenchWord& answer = words.m_answers[std::uniform_int_distribution<std::size_t> (0, words.m_answers.size () - 1) (rng)];
+        f = patternToString<BENCH_LENGTH> (computeFeedback (guess, answer));
+    }
+    LiveWords filtered = words.start ();
+    std::size_t next = 0;
+    timeKernel ("filter", name, words.m_answers.size (), "words", minSeconds, [&] () {
+        filtered = words.start ();
+        Knowledge<BENCH_LENGTH> knowledge;
+        applyFeedback (knowledge, words, filtered, guess, feedback[next++ % feedback.size ()]);
+        return std::uint64_t (filtered.m_possibleWords.count ());
+    });
+
+    // The letter-frequency heuristic over the whole dictionary.
+    timeKernel ("frequency best", name, words.m_answers.size (), "words", minSeconds, [&] () {
+        return std::uint64_t (words.bestWord (words.start (), rng).m_bits);
+    });
+
+    // The pattern matrix and entropy scoring, with every word a guess but only some of them answers.
+    std::vector<BenchWord> answers (dictionary.begin (), dictionary.begin () + std::min (dictionary.size (), MAX_BENCH_ANSWERS));
+    std::vector<BenchWord> extra (dictionary.begin () + answers.size (), dictionary.end ());
+    WordCollection<BENCH_LENGTH> split (answers, extra);
+    std::size_t pairs = split.m_guesses.size () * split.m_answers.size ();
+    std::unique_ptr<PatternMatrix<BENCH_LENGTH>> patterns;
+    timeKernel ("pattern matrix", name, pairs, "pairs", minSeconds, [&] () {
+        patterns.reset (new PatternMatrix<BENCH_LENGTH> (split.m_guesses, split.m_answers, 1));
+        return std::uint64_t (patterns->row (pairs % split.m_guesses.size ())[0]);
+    });
+    EntropyStrategy<BENCH_LENGTH> entropy;
+    Scratch::forThisThread ().reserve (split.m_guesses.size ());
+    timeKernel ("entropy best", name, pairs, "pairs", minSeconds, [&] () {
+        return std::uint64_t (split.bestWord (split.start (), entropy, *patterns, rng, 1).m_bits);
+    });
+    std::unique_ptr<PatternMatrix<BENCH_LENGTH>> unstored = PatternMatrix<BENCH_LENGTH>::onTheFly (split.m_guesses, split.m_answers);
+    timeKernel ("on-the-fly best", name, pairs, "pairs", minSeconds, [&] () {
+        return std::uint64_t (split.bestWord (split.start (), entropy, *unstored, rng, 1).m_bits);
+    });
+
+    // A few guesses against every word as a possible answer, which for a big enough dictionary is more answers
+    //   than a 16-bit histogram could count.
+    if (words.m_answers.size () > UINT16_MAX) {
+        std::unique_ptr<PatternMatrix<BENCH_LENGTH>> wide = PatternMatrix<BENCH_LENGTH>::onTheFly (words.m_guesses, words.m_answers);
+        std::vector<std::uint32_t> candidates (WIDE_BENCH_GUESSES);
+        for (std::size_t c = 0; c < candidates.size (); ++c) { candidates[c] = c * (words.m_guesses.size () / candidates.size ()); }
+        timeKernel ("wide best", name, candidates.size () * words.m_answers.size (), "pairs", minSeconds, [&] () {
+            return std::uint64_t (words.bestWordAmong (words.start (), entropy, *wide, candidates, rng, 1).m_bits);
+        });
+    }
+}
+
+int
+main (int argc, char* argv[]) {
+    std::string dictName = "words";
+    std::vector<std::size_t> sizes = DEFAULT_SYNTHETIC_SIZES;
+    double minSeconds = DEFAULT_MIN_SECONDS;
+    for (int arg = 1; arg < argc; ++arg) {
+        std::string option = argv[arg];
+        if (option == "--seconds" && arg + 1 < argc) { minSeconds = std::atof (argv[++arg]); }
+        else if (option == "--sizes" && arg + 1 < argc) {
+            sizes.clear ();
+            std::istringstream in (argv[++arg]);
+            for (std::string size; std::getline (in, size, ','); ) { sizes.push_back (std::strtoul (size.c_str (), nullptr, 10)); }
+        }
+        else { dictName = option; }
+    }
+    std::vector<BenchWord> dictionary;
+    if (!loadDictionary (dictName, dictionary) || dictionary.empty ()) {
+        std::cerr << "Could not read any " << BENCH_LENGTH << "-letter words from " << dictName << "\n";
+        return 1;
+    }
+    benchDictionary (dictName, dictionary, minSeconds);
+    for (std::size_t size : sizes) {
+        benchDictionary ("synthetic " + std::to_string (size / 1000) + "k", syntheticDictionary (dictionary, size, size), minSeconds);
+    }
+    return 0;
+}
@@ -0,0 +1,355 @@
+/// \file treeworker.h
+/// \author Chad Hogg
+/// \version 2026-10-14
+/// Sharing a decision-tree search with other machines: a TreeWorker serves pieces of one over TCP,
+///   and RemoteTreeHelpers hands pieces to such workers for a TreeSearch that is building a tree.
+/// This is kept out of chwordlebot.h so that programs that only play games do not pull in sockets.
+
+#ifndef CHWORDLEBOT_TREEWORKER_H
+#define CHWORDLEBOT_TREEWORKER_H
+
+#include <limits>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include "chwordlebot.h"
+
+/// \brief A TCP connection for sending requests and getting responses a line at a time, waiting for each.
+class LineConnection {
+public:
+
+    /// \brief Takes over a connected socket.
+    /// \param[in] fd The socket, which this closes when it is done.
+    explicit LineConnection (int fd) : m_fd (fd), m_start (0) {}
+
+    ~LineConnection () { if (m_fd >= 0) { close (m_fd); } }
+
+    LineConnection (const LineConnection&) = delete;
+    LineConnection& operator= (const LineConnection&) = delete;
+
+    /// \brief Connects to a server.
+    /// \param[in] address The host and port, as host:port.
+    /// \param[out] problem What went wrong, if it did not work.
+    /// \return The connection, or nullptr if there is none.
+    static std::unique_ptr<LineConnection> connectTo (const std::string& address, std::string& problem) {
+        std::size_t colon = address.rfind (':');
+        if (colon == std::string::npos) {
+            problem = "no port in " + address;
+            return nullptr;
+        }
+        addrinfo hints = {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* found = nullptr;
+        int status = getaddrinfo (address.substr (0, colon).c_str (), address.substr (colon + 1).c_str (), &hints, &found);
+        if (status != 0) {
+            problem = gai_strerror (status);
+            return nullptr;
+        }
+        int fd = -1;
+        for (addrinfo* option = found; option && fd < 0; option = option->ai_next) {
+            fd = socket (option->ai_family, option->ai_socktype, option->ai_protocol);
+            if (fd >= 0 && connect (fd, option->ai_addr, option->ai_addrlen) != 0) {
+                problem = std::strerror (errno);
+                close (fd);
+                fd = -1;
+            }
+        }
+        freeaddrinfo (found);
+        if (fd < 0) { return nullptr; }
+        int yes = 1;
+        setsockopt (fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof (yes));
+        return std::unique_ptr<LineConnection> (new LineConnection (fd));
+    }
+
+    /// \brief Makes sending and waiting for lines give up after a while, so a peer that stops answering counts as a broken connection.
+    /// \param[in] seconds How long to wait, or 0 to wait forever.
+    void setTimeout (unsigned int seconds) {
+        timeval limit = {};
+        limit.tv_sec = seconds;
+        setsockopt (m_fd, SOL_SOCKET, SO_RCVTIMEO, &limit, sizeof (limit));
+        setsockopt (m_fd, SOL_SOCKET, SO_SNDTIMEO, &limit, sizeof (limit));
+    }
+
+    /// \brief Sends some text, which should end with a newline.
+    /// \return False if the connection is broken; true otherwise.
+    bool send (const std::string& text) {
+        for (std::size_t sent = 0; sent < text.length (); ) {
+            ssize_t wrote = ::send (m_fd, text.data () + sent, text.length () - sent, MSG_NOSIGNAL);
+            if (wrote < 0 && errno == EINTR) { continue; }
+            if (wrote <= 0) { return false; }
+            sent += wrote;
+        }
+        return true;
+    }
+
+    /// \brief Waits for the next line.
+    /// \param[out] line The line, without its newline.
+    /// \param[in] maxLength The longest line to accept.
+    /// \return False if the connection closed, broke or timed out first, or the line is too long; true otherwise.
+    bool readLine (std::string& line, std::size_t maxLength = SIZE_MAX) {
+        while (true) {
+            std::size_t end = m_buffer.find ('\n', m_start);
+            if (end != std::string::npos) {
+                line.assign (m_buffer, m_start, end - m_start);
+                m_start = end + 1;
+                return true;
+            }
+            m_buffer.erase (0, m_start);
+            m_start = 0;
+            if (m_buffer.length () > maxLength) { return false; }
+            char chunk[READ_SIZE];
+            ssize_t got = recv (m_fd, chunk, sizeof (chunk), 0);
+            if (got < 0 && errno == EINTR) { continue; }
+            if (got <= 0) { return false; }
+            m_buffer.append (chunk, got);
+        }
+    }
+
+private:
+
+    /// \brief How much to read at a time.
+    static constexpr std::size_t READ_SIZE = 1 << 16;
+
+    int m_fd;
+    /// \brief What has been read but not yet returned, which starts at m_start.
+    std::string m_buffer;
+    std::size_t m_start;
+};
+
+
+/// \brief Writes a set of answers into a request, as its size and then the indices.
+inline void
+writeAnswers (std::ostream& out, const std::uint32_t* answers, std::size_t count) {
+    out << count;
+    for (std::size_t a = 0; a < count; ++a) { out << " " << answers[a]; }
+}
+
+/// \brief Reads a set of answers written by writeAnswers ().
+/// \param[in,out] in The request.
+/// \param[in] numAnswers The number of answers in the dictionary, which every index must be below.
+/// \param[out] answers The indices.
+/// \return False if the set was malformed or empty; true otherwise.
+inline bool
+readAnswers (std::istream& in, std::size_t numAnswers, std::vector<std::uint32_t>& answers) {
+    std::size_t count = 0;
+    if (!(in >> count) || count == 0 || count > numAnswers) { return false; }
+    answers.resize (count);
+    for (std::uint32_t& answer : answers) {
+        if (!(in >> answer) || answer >= numAnswers) { return false; }
+    }
+    return true;
+}
+
+
+/// \brief Serves pieces of a decision-tree search to a coordinator on another machine.
+/// The requests and responses are lines of text:
+///   HELLO dictionaryHash breadth  ->  OK, or ERROR and a reason if this worker was started differently
+///   SOLVE guessesLeft bound count answer...  ->  COST cost
+///   TREE guessesLeft count answer...  ->  TREE lines worst, followed by that many lines of moves (as OpeningBook::writeMoves () writes them)
+/// Answers are indices into the sorted list of answers, which both ends have since the dictionary hashes match.
+/// Each connection gets its own thread, and they all share one search, so its memo table is shared too;
+///   a coordinator that wants several cores here opens several connections.
+template <std::size_t WORD_LENGTH>
+class TreeWorker {
+public:
+
+    /// \brief Sets up a worker.
+    /// \param[in] words The words that might be guessed and the words that might be the answer.
+    /// \param[in] strategy The strategy that decides which guesses are worth trying.
+    /// \param[in] patterns The feedback for every allowed guess against every answer.
+    /// \param[in] breadth The number of guesses to try at each point, which has to match the coordinator's.
+    /// \param[in] memoSize The most subtrees to remember.
+    /// \param[in] device A GPU to rank guesses on, or nullptr to do it all on the CPU.
+    TreeWorker (const WordCollection<WORD_LENGTH>& words, const ScoringStrategy<WORD_LENGTH>& strategy, const PatternMatrix<WORD_LENGTH>& patterns,
+                std::size_t breadth, std::size_t memoSize, const DeviceScorer<WORD_LENGTH>* device)
+    : m_words (words), m_breadth (breadth), m_search (words, strategy, patterns, breadth, memoSize, device) {}
+
+    /// \brief Listens for coordinators and answers their requests, forever.
+    /// \param[in] port The TCP port to listen on.
+    /// \param[in,out] log The stream to report to.
+    /// \return False if it could not listen; otherwise it does not return.
+    bool run (unsigned short port, std::ostream& log) {
+        int listener = socket (AF_INET, SOCK_STREAM, 0);
+        int yes = 1;
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl (INADDR_ANY);
+        address.sin_port = htons (port);
+        if (listener < 0 || setsockopt (listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof (yes)) != 0
+            || bind (listener, reinterpret_cast<sockaddr*> (&address), sizeof (address)) != 0 || listen (listener, SOMAXCONN) != 0) {
+            log << "Could not listen on port " << port << ": " << std::strerror (errno) << "\n";
+            return false;
+        }
+        log << "Waiting for tree searches on port " << port << "\n";
+        while (true) {
+            int fd = accept (listener, nullptr, nullptr);
+            if (fd < 0) { continue; }
+            setsockopt (fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof (yes));
+            std::thread ([this, fd] () { serve (fd); }).detach ();
+        }
+    }
+
+private:
+
+    /// \brief Answers one coordinator's requests until it hangs up.
+    /// \param[in] fd The connection, which this closes.
+    void serve (int fd) {
+        LineConnection connection (fd);
+        std::vector<std::uint32_t> answers;
+        // The longest request lists every answer, and no index is longer than an unsigned int.
+        std::size_t maxLine = MAX_REQUEST_HEADER + (m_words.m_answers.size () + 1) * (std::numeric_limits<unsigned int>::digits10 + 2);
+        for (std::string line; connection.readLine (line, maxLine); ) {
+            std::istringstream request (line);
+            std::string command;
+            request >> command;
+            std::ostringstream response;
+            unsigned int guessesLeft = 0;
+            if (command == "HELLO") {
+                std::uint64_t hash = 0;
+                std::size_t breadth = 0;
+                request >> hash >> breadth;
+                if (hash != m_words.hash ()) { response << "ERROR this worker has a different dictionary\n"; }
+                else if (breadth != m_breadth) { response << "ERROR this worker tries " << m_breadth << " guesses at each point\n"; }
+                else { response << "OK\n"; }
+            }
+            else if (command == "SOLVE") {
+                std::uint64_t bound = 0;
+                if (!(request >> guessesLeft >> bound) || !readAnswers (request, m_words.m_answers.size (), answers)) {
+                    response << "ERROR malformed SOLVE\n";
+                }
+                else { response << "COST " << m_search.cost (answers.data (), answers.size (), guessesLeft, bound) << "\n"; }
+            }
+            else if (command == "TREE") {
+                std::string moves;
+                unsigned int worst = 0;
+                if (!(request >> guessesLeft) || !readAnswers (request, m_words.m_answers.size (), answers)) { response << "ERROR malformed TREE\n"; }
+                else if (!m_search.subtree (answers.data (), answers.size (), guessesLeft, moves, worst)) {
+                    response << "ERROR no subtree is short enough\n";
+                }
+                else { response << "TREE " << std::count (moves.begin (), moves.end (), '\n') << " " << worst << "\n" << moves; }
+            }
+            else { response << "ERROR unknown request " << command << "\n"; }
+            if (!connection.send (response.str ())) { return; }
+        }
+    }
+
+    /// \brief Room in a request line for everything but its answers.
+    static constexpr std::size_t MAX_REQUEST_HEADER = 256;
+
+    const WordCollection<WORD_LENGTH>& m_words;
+    std::size_t m_breadth;
+    TreeSearch<WORD_LENGTH> m_search;
+};
+
+
+/// \brief Hands pieces of a decision-tree search to TreeWorkers on other machines.
+/// A helper whose connection breaks, or that says something unexpected, is dropped, and its pieces are done here.
+template <std::size_t WORD_LENGTH>
+class RemoteTreeHelpers : public TreeSearch<WORD_LENGTH>::Helpers {
+public:
+
+    /// \brief Connects to the workers.
+    /// \param[in] addresses The workers, as host:port; one that appears more than once gets that many connections.
+    /// \param[in] dictionaryHash The hash of the dictionary, which each worker has to have too.
+    /// \param[in] breadth The number of guesses to try at each point, which each worker has to use too.
+    /// \param[in] timeout How many seconds to wait on a worker before dropping it, or 0 to wait forever.
+    /// \param[in,out] log The stream to report to.
+    /// Workers that can not be reached, or that do not match, are left out.
+    RemoteTreeHelpers (const std::vector<std::string>& addresses, std::uint64_t dictionaryHash, std::size_t breadth, unsigned int timeout,
+                       std::ostream& log)
+    : m_log (log) {
+        for (const std::string& address : addresses) {
+            std::string problem, reply;
+            std::unique_ptr<LineConnection> connection = LineConnection::connectTo (address, problem);
+            if (!connection && problem.empty ()) { problem = "could not connect"; }
+            if (connection) { connection->setTimeout (timeout); }
+            if (connection && !(connection->send ("HELLO " + std::to_string (dictionaryHash) + " " + std::to_string (breadth) + "\n")
+                                && connection->readLine (reply))) {
+                problem = "it hung up or did not answer";
+            }
+            else if (connection && reply != "OK") { problem = reply; }
+            if (!problem.empty ()) {
+                log << "Leaving out the tree worker at " << address << ": " << problem << "\n";
+                continue;
+            }
+            m_connections.push_back (std::move (connection));
+            m_addresses.push_back (address);
+        }
+        log << "Sharing the tree search with " << m_connections.size () << " remote workers\n";
+    }
+
+    virtual std::size_t size () const { return m_connections.size (); }
+
+    virtual bool solve (std::size_t helper, const std::uint32_t* answers, std::size_t count, unsigned int guessesLeft, std::uint64_t bound,
+                        std::uint64_t& cost) {
+        std::ostringstream request;
+        request << "SOLVE " << guessesLeft << " " << bound << " ";
+        writeAnswers (request, answers, count);
+        request << "\n";
+        std::string reply, word;
+        if (!exchange (helper, request.str (), reply)) { return false; }
+        std::istringstream in (reply);
+        if (!(in >> word >> cost) || word != "COST") { return drop (helper, reply); }
+        return true;
+    }
+
+    virtual bool subtree (std::size_t helper, const std::uint32_t* answers, std::size_t count, unsigned int guessesLeft,
+                          std::string& moves, unsigned int& worst) {
+        std::ostringstream request;
+        request << "TREE " << guessesLeft << " ";
+        writeAnswers (request, answers, count);
+        request << "\n";
+        std::string reply, word;
+        std::size_t lines = 0;
+        if (!exchange (helper, request.str (), reply)) { return false; }
+        std::istringstream in (reply);
+        if (!(in >> word >> lines >> worst) || word != "TREE") { return drop (helper, reply); }
+        // Each answer is solved by one move, and every other move splits its set in two or more, so there are fewer than twice as many.
+        if (lines == 0 || lines >= 2 * count || worst == 0 || worst > guessesLeft) { return drop (helper, "it sent an impossible tree: " + reply); }
+        std::size_t numMoves = lines;
+        moves.clear ();
+        for (std::string line; lines > 0; --lines) {
+            if (!m_connections[helper]->readLine (line, MAX_MOVE_LINE)) { return drop (helper, "it hung up, stopped answering or sent a line that is too long"); }
+            moves += line + "\n";
+        }
+        // The coordinator checks the guesses against its own list, but everything else about the moves is checked here.
+        std::istringstream check (moves);
+        OpeningBook<WORD_LENGTH> scratch (0, "");
+        if (!scratch.readMoves (check, std::vector<Pattern<WORD_LENGTH>> (1, 0)) || scratch.size () != numMoves) {
+            return drop (helper, "it sent malformed moves");
+        }
+        return true;
+    }
+
+private:
+
+    /// \brief The longest line of moves there can be: a full book path and a guess, with room to spare.
+    static constexpr std::size_t MAX_MOVE_LINE = OpeningBook<WORD_LENGTH>::MAX_DEPTH * (WORD_LENGTH + 1) + WORD_LENGTH + 16;
+
+    /// \brief Sends a request to a helper that is still in use and waits for the first line of its response.
+    bool exchange (std::size_t helper, const std::string& request, std::string& reply) {
+        if (!m_connections[helper]) { return false; }
+        if (!m_connections[helper]->send (request) || !m_connections[helper]->readLine (reply)) { return drop (helper, "it hung up or stopped answering"); }
+        return true;
+    }
+
+    /// \brief Stops using a helper.
+    /// \return False, for passing on.
+    bool drop (std::size_t helper, const std::string& problem) {
+        m_log << "Doing the rest of the work of the tree worker at " << m_addresses[helper] << " here: " << problem << "\n";
+        m_connections[helper].reset ();
+        return false;
+    }
+
+    std::vector<std::unique_ptr<LineConnection>> m_connections;
+    std::vector<std::string> m_addresses;
+    std::ostream& m_log;
+};
+
+#endif